@@ -4,26 +4,69 @@
 #
 #-------------------------------------------------
 
-QT       += core gui sql
+QT       += core gui sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = DatabaseManager
 TEMPLATE = app
 
+#编译期表结构(tableschema.h)需要C++14
+CONFIG += c++14
+
+#使用sqlite3的C接口(增量BLOB读写等Qt未封装的功能)。要求QSQLITE驱动插件与这里链接的是同一个
+#sqlite3库(Qt编译时configure -system-sqlite)。连接时会比较两者的sqlite_source_id()，不一致时
+#原生接口在运行时自动关闭(语句改用QSqlQuery执行，BLOB流式读写等接口返回失败)。没有安装
+#系统sqlite3开发库时注释掉下面两行
+DEFINES += SQLITE_NATIVE_API
+LIBS += -lsqlite3
+
+#大字段的透明压缩(columncodec.h)使用zlib的预置字典
+LIBS += -lz
+
 
 SOURCES += main.cpp\
     databasemanager.cpp \
     widget.cpp \
     mythread.cpp \
-    mythread2.cpp
+    mythread2.cpp \
+    tablelockmanager.cpp \
+    readsnapshot.cpp \
+    arenaresultset.cpp \
+    sqliteblobdevice.cpp \
+    sqlitestatement.cpp \
+    partitionedtable.cpp \
+    cappedtable.cpp \
+    tablemirror.cpp \
+    shardeddatabasemanager.cpp \
+    tablepager.cpp \
+    changeset.cpp \
+    columncodec.cpp \
+    databasescheduler.cpp \
+    operationdeadline.cpp
 
 HEADERS  += \
     databasemanager.h \
     widget.h \
     globalvar.h \
     mythread.h \
-    mythread2.h
+    mythread2.h \
+    tablelockmanager.h \
+    readsnapshot.h \
+    arenaresultset.h \
+    sqliteblobdevice.h \
+    sqlitestatement.h \
+    tableschema.h \
+    recordmapping.h \
+    partitionedtable.h \
+    cappedtable.h \
+    tablemirror.h \
+    shardeddatabasemanager.h \
+    tablepager.h \
+    changeset.h \
+    columncodec.h \
+    databasescheduler.h \
+    operationdeadline.h
 
 FORMS += \
     widget.ui
@@ -0,0 +1,319 @@
+/*
+ *@file:   arenaresultset.cpp
+ *@date:   2026.10.19
+ *@brief:  基于内存池(arena)的查询结果集
+ */
+#include "arenaresultset.h"
+#include <string.h>
+
+//内存池中数据按8字节对齐
+#define ARENA_ALIGNMENT 8
+
+ArenaResultSet::ArenaResultSet(int blockSize)
+    :blockSize(qMax(blockSize,1024)),currentBlock(0),blockOffset(0),
+      columns(0),allocations(0),usedBytes(0)
+{
+}
+
+ArenaResultSet::~ArenaResultSet()
+{
+    reset();
+    for(int i=0;i<blocks.size();i++)
+    {
+        delete[] blocks.at(i);
+    }
+    blocks.clear();
+}
+/*
+ *@brief:   清空结果集 已分配的内存块和类型槽数组的容量都会保留，供下一次查询复用
+ *@date:    2026.10.19
+ *@param:   columnCount:下一次查询结果的列数
+ */
+void ArenaResultSet::reset(int columnCount)
+{
+    for(int i=0;i<largeAllocations.size();i++)
+    {
+        delete[] largeAllocations.at(i);
+    }
+    largeAllocations.clear();
+    cells.clear();
+    currentBlock = 0;
+    blockOffset = 0;
+    usedBytes = 0;
+    columns = columnCount;
+}
+
+int ArenaResultSet::rowCount() const
+{
+    if(columns <= 0)
+    {
+        return 0;
+    }
+    return int(cells.size())/columns;
+}
+
+int ArenaResultSet::columnCount() const
+{
+    return columns;
+}
+
+ArenaResultSet::CellType ArenaResultSet::cellType(int row, int column) const
+{
+    return cell(row,column).type;
+}
+
+bool ArenaResultSet::isNull(int row, int column) const
+{
+    return cell(row,column).type == NullCell;
+}
+
+qint64 ArenaResultSet::toInt64(int row, int column) const
+{
+    const Cell &c = cell(row,column);
+    switch(c.type)
+    {
+    case IntegerCell:
+        return c.integer;
+    case RealCell:
+        return qint64(c.real);
+    case TextCell:
+        return QString::fromRawData(reinterpret_cast<const QChar *>(c.data),c.size).toLongLong();
+    default:
+        return 0;
+    }
+}
+
+double ArenaResultSet::toDouble(int row, int column) const
+{
+    const Cell &c = cell(row,column);
+    switch(c.type)
+    {
+    case IntegerCell:
+        return double(c.integer);
+    case RealCell:
+        return c.real;
+    case TextCell:
+        return QString::fromRawData(reinterpret_cast<const QChar *>(c.data),c.size).toDouble();
+    default:
+        return 0;
+    }
+}
+/*
+ *@brief:   获取字符串视图 不拷贝数据，指针在下一次reset()之前有效
+ *@date:    2026.10.19
+ *@param:   size:返回字符串的QChar个数
+ *@return:  const QChar*:字符串首地址，非字符串单元格返回0
+ */
+const QChar *ArenaResultSet::textData(int row, int column, int *size) const
+{
+    const Cell &c = cell(row,column);
+    if(c.type != TextCell)
+    {
+        *size = 0;
+        return 0;
+    }
+    *size = c.size;
+    return reinterpret_cast<const QChar *>(c.data);
+}
+
+QString ArenaResultSet::toString(int row, int column) const
+{
+    const Cell &c = cell(row,column);
+    switch(c.type)
+    {
+    case IntegerCell:
+        return QString::number(c.integer);
+    case RealCell:
+        return QString::number(c.real);
+    case TextCell:
+        return QString(reinterpret_cast<const QChar *>(c.data),c.size);
+    case BlobCell:
+        return QString::fromUtf8(c.data,c.size);
+    default:
+        return QString();
+    }
+}
+
+QByteArray ArenaResultSet::toByteArray(int row, int column) const
+{
+    const Cell &c = cell(row,column);
+    switch(c.type)
+    {
+    case BlobCell:
+        return QByteArray(c.data,c.size);
+    case NullCell:
+        return QByteArray();
+    default:
+        return toString(row,column).toUtf8();
+    }
+}
+
+QVariant ArenaResultSet::value(int row, int column) const
+{
+    const Cell &c = cell(row,column);
+    switch(c.type)
+    {
+    case IntegerCell:
+        return QVariant(c.integer);
+    case RealCell:
+        return QVariant(c.real);
+    case TextCell:
+        return QVariant(toString(row,column));
+    case BlobCell:
+        return QVariant(toByteArray(row,column));
+    default:
+        return QVariant();
+    }
+}
+
+void ArenaResultSet::appendNull()
+{
+    Cell c;
+    c.type = NullCell;
+    c.size = 0;
+    c.data = 0;
+    appendCell(c);
+}
+
+void ArenaResultSet::appendInt64(qint64 value)
+{
+    Cell c;
+    c.type = IntegerCell;
+    c.size = 0;
+    c.integer = value;
+    appendCell(c);
+}
+
+void ArenaResultSet::appendDouble(double value)
+{
+    Cell c;
+    c.type = RealCell;
+    c.size = 0;
+    c.real = value;
+    appendCell(c);
+}
+
+void ArenaResultSet::appendText(const QChar *text, int size)
+{
+    Cell c;
+    c.type = TextCell;
+    c.size = size;
+    char *data = allocate(size*int(sizeof(QChar)));
+    memcpy(data,text,size*sizeof(QChar));
+    c.data = data;
+    appendCell(c);
+}
+
+void ArenaResultSet::appendBlob(const char *data, int size)
+{
+    Cell c;
+    c.type = BlobCell;
+    c.size = size;
+    char *buffer = allocate(size);
+    memcpy(buffer,data,size);
+    c.data = buffer;
+    appendCell(c);
+}
+/*
+ *@brief:   按QVariant的类型追加单元格 用于从QSqlQuery填充结果集
+ *@date:    2026.10.19
+ *@param:   value:单元格的值
+ */
+void ArenaResultSet::appendVariant(const QVariant &value)
+{
+    if(value.isNull())
+    {
+        appendNull();
+        return;
+    }
+    switch(int(value.type()))
+    {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Bool:
+        appendInt64(value.toLongLong());
+        break;
+    case QVariant::Double:
+        appendDouble(value.toDouble());
+        break;
+    case QVariant::ByteArray:
+    {
+        //constData()直接引用QVariant内部的数据，不产生临时拷贝
+        const QByteArray &bytes = *reinterpret_cast<const QByteArray *>(value.constData());
+        appendBlob(bytes.constData(),bytes.size());
+        break;
+    }
+    case QVariant::String:
+    {
+        const QString &text = *reinterpret_cast<const QString *>(value.constData());
+        appendText(text.constData(),text.size());
+        break;
+    }
+    default:
+    {
+        QString text = value.toString();
+        appendText(text.constData(),text.size());
+        break;
+    }
+    }
+}
+
+qint64 ArenaResultSet::allocationCount() const
+{
+    return allocations;
+}
+
+qint64 ArenaResultSet::bytesUsed() const
+{
+    return usedBytes;
+}
+
+const ArenaResultSet::Cell &ArenaResultSet::cell(int row, int column) const
+{
+    return cells[size_t(row)*columns+column];
+}
+
+void ArenaResultSet::appendCell(const Cell &cell)
+{
+    //类型槽数组按倍数扩容，扩容时计一次分配
+    if(cells.size() == cells.capacity())
+    {
+        allocations++;
+    }
+    cells.push_back(cell);
+}
+/*
+ *@brief:   从内存池分配内存 当前内存块不够时依次复用后续的内存块，都不够时
+ * 再新分配一块，超过内存块大小的数据单独分配
+ *@date:    2026.10.19
+ *@param:   size:字节数
+ *@return:  char*:分配的内存地址
+ */
+char *ArenaResultSet::allocate(int size)
+{
+    int alignedSize = (size+ARENA_ALIGNMENT-1) & ~(ARENA_ALIGNMENT-1);
+    usedBytes += alignedSize;
+    if(alignedSize > blockSize/4)
+    {
+        char *buffer = new char[alignedSize > 0 ? alignedSize : ARENA_ALIGNMENT];
+        largeAllocations.append(buffer);
+        allocations++;
+        return buffer;
+    }
+    while(currentBlock < blocks.size() && blockOffset+alignedSize > blockSize)
+    {
+        currentBlock++;
+        blockOffset = 0;
+    }
+    if(currentBlock == blocks.size())
+    {
+        blocks.append(new char[blockSize]);
+        allocations++;
+        blockOffset = 0;
+    }
+    char *buffer = blocks.at(currentBlock)+blockOffset;
+    blockOffset += alignedSize;
+    return buffer;
+}
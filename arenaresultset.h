@@ -0,0 +1,94 @@
+/*
+ *@file:   arenaresultset.h
+ *@date:   2026.10.19
+ *@brief:  基于内存池(arena)的查询结果集
+ * 普通的查询接口返回QList<QVariant>,每个单元格都是一个堆上分配的QVariant，字符串列还
+ * 要再分配一次QString,查询10万行数据就要分配20万次内存。
+ * 该结果集把所有单元格存放在一个连续的类型槽数组中(整型/浮点直接存值)，字符串和二进制
+ * 数据则按顺序拷贝到预先分配的大块内存里，单元格中只记录指针和长度(视图)。每次查询前
+ * 调用reset()只是把分配位置归零，内存块会被复用，所以连续查询时几乎没有新的内存分配。
+ *
+ * 注:1.字符串以UTF-16保存，textData()返回的指针在下一次reset()之前有效。
+ *    2.该结果集是可选的，通过DatabaseManager::selectResultSet()使用，原有接口不受影响。
+ *    3.结果集本身不加锁，不能在多个线程中同时使用。
+ */
+#ifndef ARENARESULTSET_H
+#define ARENARESULTSET_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVariant>
+#include <QVector>
+#include <vector>
+
+class ArenaResultSet
+{
+public:
+    enum CellType
+    {
+        NullCell,
+        IntegerCell,
+        RealCell,
+        TextCell,
+        BlobCell
+    };
+    //类型槽 整型/浮点直接存值，字符串/二进制存内存池中的视图
+    struct Cell
+    {
+        CellType type;
+        int size;//字符串的QChar个数或二进制的字节数
+        union
+        {
+            qint64 integer;
+            double real;
+            const char *data;
+        };
+    };
+
+    explicit ArenaResultSet(int blockSize = 64*1024);
+    ~ArenaResultSet();
+
+    void reset(int columnCount = 0);//清空结果并复用已分配的内存块
+    int rowCount() const;
+    int columnCount() const;
+
+    //读取单元格
+    CellType cellType(int row,int column) const;
+    bool isNull(int row,int column) const;
+    qint64 toInt64(int row,int column) const;
+    double toDouble(int row,int column) const;
+    const QChar *textData(int row,int column,int *size) const;//零拷贝的字符串视图
+    QString toString(int row,int column) const;//拷贝为QString
+    QByteArray toByteArray(int row,int column) const;//拷贝为QByteArray
+    QVariant value(int row,int column) const;//转换为QVariant 兼容原有接口
+
+    //写入单元格 按行优先顺序依次追加
+    void appendNull();
+    void appendInt64(qint64 value);
+    void appendDouble(double value);
+    void appendText(const QChar *text,int size);
+    void appendBlob(const char *data,int size);
+    void appendVariant(const QVariant &value);
+
+    //内存分配统计 用于对比普通查询接口的分配次数
+    qint64 allocationCount() const;//累计的堆内存分配次数
+    qint64 bytesUsed() const;//当前结果占用的内存池字节数
+
+private:
+    Q_DISABLE_COPY(ArenaResultSet)
+    const Cell &cell(int row,int column) const;
+    void appendCell(const Cell &cell);
+    char *allocate(int size);
+
+    int blockSize;//内存块大小
+    QVector<char *> blocks;//复用的内存块
+    int currentBlock;//当前分配的内存块下标
+    int blockOffset;//当前内存块已分配的字节数
+    QVector<char *> largeAllocations;//超过内存块大小的数据单独分配，reset()时释放
+    std::vector<Cell> cells;//类型槽数组 clear()后保留容量
+    int columns;
+    qint64 allocations;
+    qint64 usedBytes;
+};
+
+#endif // ARENARESULTSET_H
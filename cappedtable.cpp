@@ -0,0 +1,196 @@
+/*
+ *@file:   cappedtable.cpp
+ *@date:   2026.10.19
+ *@brief:  固定容量的环形缓冲表
+ */
+#include "cappedtable.h"
+#include <QMutexLocker>
+
+#define CAPPED_SLOT_COLUMN "ring_slot"
+#define CAPPED_SEQ_COLUMN "ring_seq"
+#define CAPPED_META_SUFFIX "_meta"//保存容量的单行表
+
+CappedTable::CappedTable(DatabaseManager *databaseManager, QString tableName, int capacity)
+    :databaseManager(databaseManager),tableName(tableName),slotCount(qMax(capacity,1)),
+      isCreated(false),sequence(0)
+{
+}
+/*
+ *@brief:   建表并从已有的数据中恢复写入位置
+ *@date:    2026.10.19
+ *@param:   columnNames:数据列名
+ *@param:   columnTypes:数据列类型
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool CappedTable::create(QList<QString> columnNames, QList<QString> columnTypes)
+{
+    QMutexLocker locker(&mutex);
+    this->columnNames = columnNames;
+    writeColumnNames = columnNames;
+    writeColumnNames.prepend(CAPPED_SEQ_COLUMN);
+    QList<QString> tableColumnNames = writeColumnNames;
+    tableColumnNames.prepend(CAPPED_SLOT_COLUMN);
+    QList<QString> tableColumnTypes = columnTypes;
+    tableColumnTypes.prepend("integer not null");
+    tableColumnTypes.prepend("integer primary key");//槽位即rowid，按槽位覆盖只需一次查找
+    if(!databaseManager->createTable(tableName,tableColumnNames,tableColumnTypes))
+    {
+        return false;
+    }
+    QString indexSql = QString("create index if not exists %1_%2_idx on %1(%2);").arg(tableName,CAPPED_SEQ_COLUMN);
+    if(!databaseManager->createTable(indexSql))
+    {
+        return false;
+    }
+    //已有数据时，下一条记录的序号为最大序号+1
+    QList<QString> stateColumns;
+    stateColumns<<QString("max(%1)").arg(CAPPED_SEQ_COLUMN)<<"count(0)";
+    QVariantList state = databaseManager->selectMultiColData(tableName,stateColumns,"1=1");
+    if(state.size() != 2)
+    {
+        return false;
+    }
+    qint64 nextSeq = state.at(0).isNull() ? 0 : state.at(0).toLongLong()+1;
+    if(!checkCapacity(nextSeq,state.at(1).toLongLong()))
+    {
+        return false;
+    }
+    sequence = nextSeq;
+    isCreated = true;
+    return true;
+}
+
+/*
+ *@brief:   检查建表时保存的容量与本对象的容量是否一致 槽位按sequence%容量计算，容量
+ * 不一致时写入位置和覆盖的槽位都会错乱，所以任何不一致都返回失败。
+ * 没有保存容量的表(新表或之前版本创建的表)由已有数据推断:序号回绕过的表已满，
+ * 行数即为原容量；未回绕的表只要行数不超过容量就与之兼容。推断通过后保存本对象的容量
+ *@date:    2026.10.19
+ *@param:   nextSeq:下一条记录的序号
+ *@param:   count:表中的记录数
+ *@return:  返回值为布尔类型，true:一致，false:不一致或读写容量失败
+ */
+bool CappedTable::checkCapacity(qint64 nextSeq, qint64 count)
+{
+    QString metaTable = tableName+CAPPED_META_SUFFIX;
+    QList<QString> metaColumns;
+    metaColumns<<"capacity";
+    QList<QString> metaTypes;
+    metaTypes<<"integer not null";
+    if(!databaseManager->createTable(metaTable,metaColumns,metaTypes))
+    {
+        return false;
+    }
+    QVariantList meta = databaseManager->selectMultiColData(metaTable,metaColumns,"1=1");
+    if(!meta.isEmpty())
+    {
+        if(meta.at(0).toInt() != slotCount)
+        {
+            qDebug()<<"capped table capacity doesn't match the existing table..."<<tableName
+                    <<"stored:"<<meta.at(0).toInt()<<"requested:"<<slotCount;
+            return false;
+        }
+        return true;
+    }
+    bool isWrapped = nextSeq > count;//有槽位被覆盖过
+    if(count > slotCount || (isWrapped && count != slotCount))
+    {
+        qDebug()<<"capped table capacity doesn't match the existing table..."<<tableName<<slotCount;
+        return false;
+    }
+    QVariantList metaValues;
+    metaValues<<slotCount;
+    return databaseManager->insertTable(metaTable,metaValues,metaColumns);
+}
+
+int CappedTable::capacity()
+{
+    return slotCount;
+}
+
+int CappedTable::rowCount()
+{
+    QMutexLocker locker(&mutex);
+    return int(qMin(sequence,qint64(slotCount)));
+}
+
+qint64 CappedTable::nextSequence()
+{
+    QMutexLocker locker(&mutex);
+    return sequence;
+}
+/*
+ *@brief:   写入一条记录 表未满时插入新的槽位，表满后覆盖最旧的槽位
+ *@date:    2026.10.19
+ *@param:   rowValues:数据列的值
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool CappedTable::insert(QVariantList &rowValues)
+{
+    QMutexLocker locker(&mutex);
+    if(!isCreated || rowValues.size() != columnNames.size())
+    {
+        qDebug()<<"capped table insert error: table is not created or values don't match..."<<tableName;
+        return false;
+    }
+    QVariantList writeValues = rowValues;
+    writeValues.prepend(sequence);
+    qint64 slot = sequence%slotCount;
+    bool isSuccess;
+    if(sequence < slotCount)
+    {
+        QList<QString> insertColumnNames = writeColumnNames;
+        insertColumnNames.prepend(CAPPED_SLOT_COLUMN);
+        writeValues.prepend(slot);
+        isSuccess = databaseManager->insertTable(tableName,writeValues,insertColumnNames);
+    }
+    else
+    {
+        isSuccess = databaseManager->updateTable(tableName,writeColumnNames,writeValues,CAPPED_SLOT_COLUMN,slot);
+        //槽位的行不存在(被外部删除)时update成功但没有写入任何数据
+        if(isSuccess && databaseManager->lastRowsAffected() != 1)
+        {
+            qDebug()<<"capped table insert error: slot row doesn't exist..."<<tableName<<slot;
+            isSuccess = false;
+        }
+    }
+    if(isSuccess)
+    {
+        sequence++;
+    }
+    return isSuccess;
+}
+/*
+ *@brief:   查询最新的count条记录
+ *@date:    2026.10.19
+ *@param:   columnNames:查询的列名 为空则查询所有数据列
+ *@param:   count:条数
+ *@return:  QList<QVariantList>:按新到旧排列的记录，每个元素为一行
+ */
+QList<QVariantList> CappedTable::selectLatest(QList<QString> columnNames, int count)
+{
+    QList<QVariantList> rows;
+    if(columnNames.isEmpty())
+    {
+        columnNames = this->columnNames;
+    }
+    QString whereSql = QString("1=1 order by %1 desc limit %2").arg(CAPPED_SEQ_COLUMN).arg(count);
+    ArenaResultSet resultSet;
+    if(!databaseManager->selectResultSet(resultSet,tableName,columnNames,whereSql))
+    {
+        return rows;
+    }
+    int rowCount = resultSet.rowCount();
+    int columnCount = resultSet.columnCount();
+    for(int row=0;row<rowCount;row++)
+    {
+        QVariantList rowValues;
+        rowValues.reserve(columnCount);
+        for(int column=0;column<columnCount;column++)
+        {
+            rowValues.append(resultSet.value(row,column));
+        }
+        rows.append(rowValues);
+    }
+    return rows;
+}
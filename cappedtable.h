@@ -0,0 +1,57 @@
+/*
+ *@file:   cappedtable.h
+ *@date:   2026.10.19
+ *@brief:  固定容量的环形缓冲表
+ * 最近事件日志这类只需要保留最近N条记录的表，原来每次insertTable()后都要selectRowCount()
+ * 再deleteTable()删除最旧的记录，表越满代价越高，删除留下的空闲页还会让文件碎片化。
+ * 环形缓冲表预先把表分成capacity个槽位(ring_slot列，即rowid)，写入时在内存中维护写入位置，
+ * 表未满时依次插入，表满之后直接在原位置覆盖最旧的槽位(update ... where ring_slot=?)，
+ * 每次写入只访问一行，代价与表的填充程度无关，数据库文件也不会继续增长。
+ * ring_seq列记录写入的序号，用于按新旧顺序查询。
+ *
+ * 用法:
+ *   CappedTable eventLog(databaseManager,"event_log",1000);
+ *   eventLog.create(columnNames,columnTypes);//建表(已存在时只恢复写入位置)
+ *   eventLog.insert(rowValues);
+ *   QList<QVariantList> rows = eventLog.selectLatest(columnNames,20);//最新的20条
+ *
+ * 注:1.容量保存在"表名_meta"表中，建表后不能修改，已有的表容量不一致时create()失败。
+ *    2.写入位置保存在内存中，同一个表只能通过一个CappedTable对象写入。
+ */
+#ifndef CAPPEDTABLE_H
+#define CAPPEDTABLE_H
+
+#include <QMutex>
+#include "databasemanager.h"
+
+class CappedTable
+{
+public:
+    CappedTable(DatabaseManager *databaseManager,QString tableName,int capacity);
+
+    //建表并恢复写入位置 columnNames/columnTypes为数据列，槽位列和序号列自动添加
+    bool create(QList<QString> columnNames,QList<QString> columnTypes);
+    int capacity();
+    int rowCount();//当前保存的记录数 不超过容量
+    qint64 nextSequence();//下一条记录的序号
+
+    //写入一条记录 rowValues顺序与create()的列名一致，表满时覆盖最旧的记录
+    bool insert(QVariantList &rowValues);
+    //按新到旧的顺序查询最新的count条记录 columnNames为空时查询所有数据列
+    QList<QVariantList> selectLatest(QList<QString> columnNames,int count);
+
+private:
+    bool checkCapacity(qint64 nextSeq,qint64 count);
+
+    DatabaseManager *databaseManager;
+    QString tableName;
+    int slotCount;//容量(槽位数)
+    QList<QString> columnNames;//数据列名
+    QList<QString> writeColumnNames;//写入时的列名(序号列+数据列)
+
+    QMutex mutex;//保护写入位置，保证槽位分配与写入是原子的
+    bool isCreated;
+    qint64 sequence;//下一条记录的序号 槽位为sequence%slotCount
+};
+
+#endif // CAPPEDTABLE_H
@@ -0,0 +1,93 @@
+/*
+ *@file:   changeset.cpp
+ *@date:   2026.10.19
+ *@brief:  表的增量变更集
+ */
+#include "changeset.h"
+#include <QFile>
+#include <QDataStream>
+#include <QDebug>
+
+#define CHANGESET_MAGIC 0x444d4353 //"DMCS"
+#define CHANGESET_VERSION 1
+
+/*
+ *@brief:   写入变更集文件 文件头(标识、版本)之后为qCompress压缩的变更数据
+ *@date:    2026.10.19
+ *@param:   fileName:文件名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool Changeset::save(const QString &fileName) const
+{
+    QByteArray data;
+    QDataStream dataStream(&data,QIODevice::WriteOnly);
+    dataStream.setVersion(QDataStream::Qt_5_0);
+    dataStream<<tableName<<keyColumnName<<columnNames<<qint32(entries.size());
+    for(int i=0;i<entries.size();i++)
+    {
+        const ChangesetEntry &entry = entries.at(i);
+        dataStream<<qint8(entry.operation)<<entry.keyValue<<entry.rowValues;
+    }
+    QFile file(fileName);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Truncate))
+    {
+        qDebug()<<"save changeset error:"<<file.errorString()<<fileName;
+        return false;
+    }
+    QDataStream fileStream(&file);
+    fileStream.setVersion(QDataStream::Qt_5_0);
+    fileStream<<quint32(CHANGESET_MAGIC)<<qint32(CHANGESET_VERSION)<<qCompress(data);
+    if(fileStream.status() != QDataStream::Ok)
+    {
+        qDebug()<<"save changeset error: write file failed..."<<fileName;
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   读取变更集文件
+ *@date:    2026.10.19
+ *@param:   fileName:文件名
+ *@return:  返回值为布尔类型，true:成功，false:文件不存在或格式错误
+ */
+bool Changeset::load(const QString &fileName)
+{
+    QFile file(fileName);
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        qDebug()<<"load changeset error:"<<file.errorString()<<fileName;
+        return false;
+    }
+    QDataStream fileStream(&file);
+    fileStream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    qint32 version = 0;
+    QByteArray compressedData;
+    fileStream>>magic>>version>>compressedData;
+    if(fileStream.status() != QDataStream::Ok || magic != CHANGESET_MAGIC || version != CHANGESET_VERSION)
+    {
+        qDebug()<<"load changeset error: invalid changeset file..."<<fileName;
+        return false;
+    }
+    QByteArray data = qUncompress(compressedData);
+    QDataStream dataStream(data);
+    dataStream.setVersion(QDataStream::Qt_5_0);
+    qint32 entryCount = 0;
+    dataStream>>tableName>>keyColumnName>>columnNames>>entryCount;
+    entries.clear();
+    for(int i=0;i<entryCount && dataStream.status() == QDataStream::Ok;i++)
+    {
+        ChangesetEntry entry;
+        qint8 operation = 0;
+        dataStream>>operation>>entry.keyValue>>entry.rowValues;
+        entry.operation = ChangesetEntry::Operation(operation);
+        entries.append(entry);
+    }
+    if(dataStream.status() != QDataStream::Ok)
+    {
+        qDebug()<<"load changeset error: corrupted changeset data..."<<fileName;
+        entries.clear();
+        return false;
+    }
+    return true;
+}
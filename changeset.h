@@ -0,0 +1,57 @@
+/*
+ *@file:   changeset.h
+ *@date:   2026.10.19
+ *@brief:  表的增量变更集
+ * 设备间同步原来调用copyTable(srcDbName,...)，每次都删除目的表并重新复制所有行，即使只有
+ * 几行发生了变化。DatabaseManager::startChangeCapture()在源表上建立触发器，把每次插入/修改/
+ * 删除的键值记录到变更日志表(表名_changelog)；writeChangeset()把日志合并(同一键值的多次修改
+ * 只保留最终结果)并连同最新的行数据写入一个压缩的变更集文件；另一个数据库通过
+ * applyChangeset()在一个事务内应用该文件。同步的代价只与变化的行数有关，与表的大小无关。
+ *
+ * 用法:
+ *   srcManager->startChangeCapture("aa","id");//只需调用一次，触发器和日志表保存在数据库中
+ *   ...//正常读写
+ *   srcManager->writeChangeset("aa","./aa.changeset");//导出上次导出之后的变化
+ *   desManager->applyChangeset("./aa.changeset",Changeset::Replace);
+ *
+ * 注:1.键值列必须唯一(主键或唯一约束)，表结构在两个数据库中需要一致。
+ *    2.没有使用sqlite的session扩展(需要SQLITE_ENABLE_SESSION编译sqlite，Qt自带的sqlite
+ *      插件不支持)，触发器方式对所有sqlite版本都可用。
+ *    3.目的表也开启了变更捕获时，应用的变更同样会被记录。
+ */
+#ifndef CHANGESET_H
+#define CHANGESET_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QList>
+
+struct ChangesetEntry
+{
+    enum Operation{Insert,Update,Delete};
+    ChangesetEntry():operation(Insert){}
+    Operation operation;
+    QVariant keyValue;
+    QVariantList rowValues;//插入/修改后的整行数据，顺序与Changeset::columnNames一致 删除时为空
+};
+
+struct Changeset
+{
+    //应用变更时的冲突处理:插入的行已存在、修改或删除的行不存在
+    enum ConflictPolicy
+    {
+        Omit,//跳过冲突的变更
+        Replace,//以变更集为准(插入已存在的行时覆盖，修改不存在的行时插入)
+        Abort//回滚整个变更集
+    };
+    QString tableName;
+    QString keyColumnName;
+    QStringList columnNames;
+    QList<ChangesetEntry> entries;
+
+    bool save(const QString &fileName) const;//写入压缩的变更集文件
+    bool load(const QString &fileName);
+};
+
+#endif // CHANGESET_H
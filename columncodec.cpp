@@ -0,0 +1,157 @@
+/*
+ *@file:   columncodec.cpp
+ *@date:   2026.10.19
+ *@brief:  大字段的透明压缩
+ */
+#include "columncodec.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <string.h>
+#include <zlib.h>
+
+#define CODEC_HEADER_SIZE 8
+#define CODEC_FLAG_TEXT 0x01 //原始值为文本(QString,按UTF-8压缩)
+#define CODEC_MAX_RATIO 1032 //deflate压缩比的理论上限
+#define CODEC_MAX_RAW_SIZE 0x7FFFF000 //QByteArray能分配的长度上限
+
+ColumnCodec::ColumnCodec(const ColumnCompressionOptions &options)
+    :options(options)
+{
+}
+/*
+ *@brief:   压缩要写入的值
+ *@date:    2026.10.19
+ *@param:   value:原始值 QString/QByteArray之外的类型不压缩
+ *@return:  QVariant:压缩后的值(QByteArray)或原始值
+ */
+QVariant ColumnCodec::compress(const QVariant &value)
+{
+    bool isText = value.type() == QVariant::String;
+    if(value.isNull() || (!isText && value.type() != QVariant::ByteArray))
+    {
+        return value;
+    }
+    QByteArray raw = isText ? value.toString().toUtf8() : value.toByteArray();
+    QByteArray compressed;
+    if(raw.size() >= options.minSize)
+    {
+        z_stream stream;
+        memset(&stream,0,sizeof(stream));
+        if(deflateInit(&stream,qBound(1,options.level,9)) == Z_OK)
+        {
+            bool isSuccess = options.dictionary.isEmpty() ||
+                    deflateSetDictionary(&stream,reinterpret_cast<const Bytef *>(options.dictionary.constData()),
+                                         uInt(options.dictionary.size())) == Z_OK;
+            compressed.resize(CODEC_HEADER_SIZE+int(deflateBound(&stream,uLong(raw.size()))));
+            stream.next_in = reinterpret_cast<Bytef *>(raw.data());
+            stream.avail_in = uInt(raw.size());
+            stream.next_out = reinterpret_cast<Bytef *>(compressed.data()+CODEC_HEADER_SIZE);
+            stream.avail_out = uInt(compressed.size()-CODEC_HEADER_SIZE);
+            isSuccess = isSuccess && deflate(&stream,Z_FINISH) == Z_STREAM_END;
+            compressed.resize(isSuccess ? CODEC_HEADER_SIZE+int(stream.total_out) : 0);
+            deflateEnd(&stream);
+        }
+    }
+    QMutexLocker locker(&statsMutex);
+    compressionStats.rawBytes += raw.size();
+    //压缩后没有变小则原样存储
+    if(compressed.isEmpty() || compressed.size() >= raw.size())
+    {
+        compressionStats.uncompressedValues++;
+        compressionStats.storedBytes += raw.size();
+        return value;
+    }
+    quint32 rawSize = quint32(raw.size());
+    compressed[0] = char(0xFF);
+    compressed[1] = 'C';
+    compressed[2] = 'Z';
+    compressed[3] = char(isText ? CODEC_FLAG_TEXT : 0);
+    compressed[4] = char(rawSize>>24);
+    compressed[5] = char(rawSize>>16);
+    compressed[6] = char(rawSize>>8);
+    compressed[7] = char(rawSize);
+    compressionStats.compressedValues++;
+    compressionStats.storedBytes += compressed.size();
+    return compressed;
+}
+quint32 ColumnCodec::dictionaryId() const
+{
+    if(options.dictionary.isEmpty())
+    {
+        return 0;
+    }
+    uLong id = adler32(0L,Z_NULL,0);
+    return quint32(adler32(id,reinterpret_cast<const Bytef *>(options.dictionary.constData()),uInt(options.dictionary.size())));
+}
+
+ColumnCompressionStats ColumnCodec::stats() const
+{
+    QMutexLocker locker(&statsMutex);
+    return compressionStats;
+}
+//是否为带压缩头的值
+bool ColumnCodec::isCompressed(const QVariant &value)
+{
+    if(value.type() != QVariant::ByteArray)
+    {
+        return false;
+    }
+    const QByteArray data = value.toByteArray();
+    return data.size() > CODEC_HEADER_SIZE && quint8(data.at(0)) == 0xFF && data.at(1) == 'C' && data.at(2) == 'Z';
+}
+/*
+ *@brief:   解压查询到的值
+ *@date:    2026.10.19
+ *@param:   value:查询到的值
+ *@param:   dictionaries:已配置的预置字典 字典标识->字典
+ *@return:  QVariant:原始值 文本还原为QString；不是压缩的值或解压失败时原样返回
+ */
+QVariant ColumnCodec::decompress(const QVariant &value, const QHash<quint32,QByteArray> &dictionaries)
+{
+    if(!isCompressed(value))
+    {
+        return value;
+    }
+    QByteArray compressed = value.toByteArray();
+    quint32 rawSize = (quint32(quint8(compressed.at(4)))<<24)|(quint32(quint8(compressed.at(5)))<<16)|
+            (quint32(quint8(compressed.at(6)))<<8)|quint32(quint8(compressed.at(7)));
+    //头中的长度来自数据库，可能被损坏或伪造，超过压缩数据能解出的上限时不分配内存，原样返回
+    if(rawSize > CODEC_MAX_RAW_SIZE || qint64(rawSize) > qint64(compressed.size()-CODEC_HEADER_SIZE)*CODEC_MAX_RATIO)
+    {
+        qDebug()<<"column decompress error: invalid raw size..."<<rawSize;
+        return value;
+    }
+    QByteArray raw(int(rawSize),Qt::Uninitialized);
+    z_stream stream;
+    memset(&stream,0,sizeof(stream));
+    if(inflateInit(&stream) != Z_OK)
+    {
+        return value;
+    }
+    stream.next_in = reinterpret_cast<Bytef *>(compressed.data()+CODEC_HEADER_SIZE);
+    stream.avail_in = uInt(compressed.size()-CODEC_HEADER_SIZE);
+    stream.next_out = reinterpret_cast<Bytef *>(raw.data());
+    stream.avail_out = uInt(raw.size());
+    int result = inflate(&stream,Z_FINISH);
+    if(result == Z_NEED_DICT)
+    {
+        //需要字典时stream.adler为压缩时使用的字典标识
+        QByteArray dictionary = dictionaries.value(quint32(stream.adler));
+        if(!dictionary.isEmpty() && inflateSetDictionary(&stream,reinterpret_cast<const Bytef *>(dictionary.constData()),
+                                                         uInt(dictionary.size())) == Z_OK)
+        {
+            result = inflate(&stream,Z_FINISH);
+        }
+    }
+    inflateEnd(&stream);
+    if(result != Z_STREAM_END || stream.total_out != rawSize)
+    {
+        qDebug()<<"column decompress error:"<<result;
+        return value;
+    }
+    if(quint8(compressed.at(3)) & CODEC_FLAG_TEXT)
+    {
+        return QString::fromUtf8(raw);
+    }
+    return raw;
+}
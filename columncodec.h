@@ -0,0 +1,73 @@
+/*
+ *@file:   columncodec.h
+ *@date:   2026.10.19
+ *@brief:  大字段的透明压缩
+ * 保存JSON、日志文本等大字段时，原样存储会让数据库文件、页缓存和flash的写入量都变大，
+ * 这类数据通常可以压缩到1/5左右。DatabaseManager::setColumnCompression()为表的某一列
+ * 配置ColumnCodec后，通过DatabaseManager插入/修改的值超过阈值时用zlib压缩后以BLOB存储，
+ * 查询时自动解压，调用者看到的仍是原来的QString/QByteArray。
+ *
+ * 压缩后的值以8字节的头开始:0xFF 'C' 'Z' 标志 原始长度(4字节大端)，之后是zlib数据流。
+ * 很多短小且相似的值(例如同一格式的JSON)单独压缩效果很差，可以提供一个包含常见内容的
+ * 预置字典(zlib preset dictionary)，压缩时两者共享字典中的字符串。
+ *
+ * 注:1.字典保存在程序中而不是数据库中，修改字典后用旧字典压缩的值无法解压(查询时原样返回BLOB)。
+ *    2.只压缩QString和QByteArray类型的值，压缩后没有变小的值原样存储。
+ *    3.需要链接zlib(LIBS += -lz)。
+ *    4.压缩配置属于单个DatabaseManager。读快照(ReadSnapshot)和启动时的后台连接在创建时
+ *      从主连接复制字典，可以正常解压；其他连接名的DatabaseManager(包括
+ *      ShardedDatabaseManager的各个分片)需要各自配置，分片表使用
+ *      ShardedDatabaseManager::setColumnCompression()一次配置所有分片。
+ */
+#ifndef COLUMNCODEC_H
+#define COLUMNCODEC_H
+
+#include <QVariant>
+#include <QByteArray>
+#include <QMutex>
+#include <QHash>
+
+//列压缩选项
+struct ColumnCompressionOptions
+{
+    ColumnCompressionOptions():minSize(256),level(6){}
+    int minSize;//不小于该字节数的值才压缩，短的值压缩收益小
+    int level;//zlib压缩级别 1(最快)-9(最小)
+    QByteArray dictionary;//预置字典 为空表示不使用
+};
+
+//列压缩统计 按写入的数据计算
+struct ColumnCompressionStats
+{
+    ColumnCompressionStats():compressedValues(0),uncompressedValues(0),rawBytes(0),storedBytes(0){}
+    qint64 savedBytes() const
+    {
+        return rawBytes-storedBytes;
+    }
+    qint64 compressedValues;//压缩存储的值的个数
+    qint64 uncompressedValues;//低于阈值或压缩后没有变小、原样存储的值的个数
+    qint64 rawBytes;//写入的原始字节数
+    qint64 storedBytes;//实际存储的字节数
+};
+
+class ColumnCodec
+{
+public:
+    explicit ColumnCodec(const ColumnCompressionOptions &options);
+
+    QVariant compress(const QVariant &value);//写入前压缩 不需要压缩时返回原值
+    quint32 dictionaryId() const;//预置字典的adler32校验值(即zlib数据流中的字典标识) 没有字典时为0
+    ColumnCompressionStats stats() const;
+
+    static bool isCompressed(const QVariant &value);
+    /*查询后解压 不是压缩的值或解压失败时返回原值。压缩时使用了字典的值，按zlib数据流中
+     *的字典标识从dictionaries(字典标识->字典)中查找字典，因此解压时不需要知道值属于哪一列*/
+    static QVariant decompress(const QVariant &value,const QHash<quint32,QByteArray> &dictionaries);
+
+private:
+    ColumnCompressionOptions options;
+    mutable QMutex statsMutex;
+    ColumnCompressionStats compressionStats;
+};
+
+#endif // COLUMNCODEC_H
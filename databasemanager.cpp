@@ -4,13 +4,100 @@
  *@brief:  操作数据库的类
  */
 #include "databasemanager.h"
-#include <QReadLocker>
-#include <QWriteLocker>
 #include <QMessageBox>
 #include <QVariant>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QThread>
+#include <QThreadStorage>
+#if QT_VERSION >= QT_VERSION_CHECK(5,10,0)
+#include <QRandomGenerator>
+#else
+#include <QCoreApplication>
+#include <QDateTime>
+#endif
+#ifdef SQLITE_NATIVE_API
+#include <sqlite3.h>
+#endif
+
+/*按键值列表批量操作时，单条sql语句in(...)内占位符的最大数量。
+ *sqlite3.32之前SQLITE_MAX_VARIABLE_NUMBER默认为999,超过该值的键值列表需要分段执行*/
+#define BATCH_KEY_CHUNK_SIZE 500
+//写操作影响的行数不超过该值时，表镜像按行刷新，否则重新加载整个表
+#define MIRROR_ROW_REFRESH_LIMIT 64
+//变更捕获的日志表和触发器名后缀
+#define CHANGELOG_SUFFIX "_changelog"
+//增量复制的水位表 保存在目的数据库中
+#define COPY_WATERMARK_TABLE "copy_watermark"
+//全文索引表和触发器名后缀
+#define FTS_SUFFIX "_fts"
+//全文检索结果摘要的最大词数
+#define FTS_SNIPPET_TOKENS 16
+//多维范围索引表和触发器名后缀
+#define RTREE_SUFFIX "_rtree"
+//每执行该数量的虚拟机指令检查一次操作期限 太小会增加开销，太大则中断不及时
+#define PROGRESS_CHECK_INSTRUCTIONS 1000
+
+/*忙等待的线程状态 同一个连接可能被多个线程使用，而忙处理器只知道连接，
+ *所以按线程记录当前语句的读写类型以及本次等待的开始时间*/
+struct BusyThreadState
+{
+    BusyThreadState():access(DatabaseManager::WriteAccess),isSeeded(false){}
+    DatabaseManager::AccessType access;//没有标记的语句(建表、提交事务等)按写操作处理
+    QElapsedTimer busyTimer;
+    bool isSeeded;//Qt5.10之前qrand()的随机种子是否已设置
+};
+static QThreadStorage<BusyThreadState *> busyThreadStates;
+//当前线程最近一次execSql()影响的行数 供lastRowsAffected()返回
+static thread_local int threadRowsAffected = 0;
+
+static BusyThreadState *busyThreadState()
+{
+    if(!busyThreadStates.hasLocalData())
+    {
+        busyThreadStates.setLocalData(new BusyThreadState());
+    }
+    return busyThreadStates.localData();
+}
+/*忙等待退避的随机抖动 返回[0,1000)的随机数。qrand()每个线程的状态默认种子相同，
+ *各线程会同步退避、同时重试，Qt5.10及以上使用全局的QRandomGenerator，之前的版本
+ *在每个线程第一次使用时按进程号、时间和线程设置种子*/
+static int busyJitter(BusyThreadState *state)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5,10,0)
+    Q_UNUSED(state);
+    return int(QRandomGenerator::global()->bounded(1000));
+#else
+    if(!state->isSeeded)
+    {
+        qsrand(uint(QCoreApplication::applicationPid())^uint(QDateTime::currentMSecsSinceEpoch())^
+               uint(quintptr(QThread::currentThreadId())));
+        state->isSeeded = true;
+    }
+    return qrand()%1000;
+#endif
+}
+//在作用域内把当前线程的语句标记为读或写
+class BusyAccessScope
+{
+public:
+    explicit BusyAccessScope(DatabaseManager::AccessType access)
+        :state(busyThreadState()),previous(state->access)
+    {
+        state->access = access;
+    }
+    ~BusyAccessScope()
+    {
+        state->access = previous;
+    }
+private:
+    BusyThreadState *state;
+    DatabaseManager::AccessType previous;
+};
 
 DatabaseManager::DatabaseManager(QString connectionName, QObject *parent)
-    :QObject(parent),readWriteLock(QReadWriteLock::Recursive)
+    :QObject(parent),transactionMutex(QMutex::Recursive),isWalMode(false),nativeApiEnabled(true),nativeHandleState(-1),stagingTimer(0),stagingFlushCount(0),
+      stagingFlushedRows(0),readBusyPolicy(1000),writeBusyPolicy(5000),isChangeNotificationEnabled(false),
+      maxChangeRowids(0),isChangeEmitPending(false)
 {
     this->connectionName = connectionName;
 }
@@ -27,27 +114,41 @@ DatabaseManager::~DatabaseManager()
  *@author:  缪庆瑞
  *@date:    2017.12.21
  *@param:   databasname: 数据库的名字
+ *@param:   options: 连接选项(内存映射I/O大小、页缓存大小、WAL模式)，默认保持sqlite的默认设置
  *@return:  返回值为布尔类型，true:成功，false:失败
  */
-bool DatabaseManager::createSqliteConnection(QString databaseName)
+bool DatabaseManager::createSqliteConnection(QString databaseName, SqliteConnectionOptions options)
 {
     //连接已创建
     if(QSqlDatabase::contains(connectionName) && db.isValid())
     {
         return true;
     }
+    startupFuture.waitForFinished();//重新连接前等待上一次的后台任务结束
+    StartupStats stats;
+    QElapsedTimer totalTimer;
+    QElapsedTimer phaseTimer;
+    totalTimer.start();
+    phaseTimer.start();
 
     //目前板子的开发环境只有sqlite驱动
+    nativeHandleState = -1;//新连接需要重新检查驱动与本程序是否使用同一个sqlite3库
     db = QSqlDatabase::addDatabase("QSQLITE",connectionName);//添加数据库驱动
     //qDebug()<<db.driver()->hasFeature(QSqlDriver::Transactions);//支持事务操作
     db.setDatabaseName(databaseName);//设置连接的数据库名
-    /*设置多连接并发访问busy超时时间,不设置默认是5000ms*/
-    //db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    /*设置多连接并发访问busy超时时间,不设置默认是5000ms
+     *原生接口可用时打开后由installBusyHandler()替换为按读写策略退避重试的忙处理器*/
+    {
+        QMutexLocker busyLocker(&busyMutex);
+        db.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(writeBusyPolicy.timeoutMsecs));
+    }
     if(!db.open())//打开数据库
     {
         qDebug()<<"open database failed:"<<db.lastError();
         return false;
     }
+    stats.openUsecs = phaseTimer.nsecsElapsed()/1000;
+    phaseTimer.restart();
     /*sqlite删除数据后，未使用的磁盘空间被添加到一个内在的空闲列表中，用于存储下次插入
      *的数据，数据库占用磁盘空间不会减少。要想减少磁盘空间占用,主要有两种方法。
      *1.在数据库建表前执行pragma auto_vacuum=1;(如果数据库已有表,则该语句无效。且该语句在
@@ -69,6 +170,80 @@ bool DatabaseManager::createSqliteConnection(QString databaseName)
     {
         qDebug()<<"pragma synchronous error"<<query.lastError();
     }
+    /*默认情况下冷数据的读取都要经过read()系统调用，且页缓存只有约2MB。可以根据设备的内存
+     *情况调大页缓存、开启内存映射I/O,并通过pageCacheStats()的命中率评估设置的效果*/
+    if(options.mmapSize >= 0)
+    {
+        if(!query.exec(QString("pragma mmap_size = %1;").arg(options.mmapSize)))
+        {
+            qDebug()<<"pragma mmap_size error"<<query.lastError();
+        }
+    }
+    if(options.cacheSize != 0)
+    {
+        if(!query.exec(QString("pragma cache_size = %1;").arg(options.cacheSize)))
+        {
+            qDebug()<<"pragma cache_size error"<<query.lastError();
+        }
+    }
+    query.finish();
+#ifdef SQLITE_NATIVE_API
+    statementCache.setHandle(sqliteHandle());//原生接口使用的连接句柄
+    if(sqliteHandle())
+    {
+        //操作期限(OperationDeadline) 执行语句期间定期检查
+        sqlite3_progress_handler(sqliteHandle(),PROGRESS_CHECK_INSTRUCTIONS,&DatabaseManager::progressHandlerCallback,this);
+    }
+#endif
+    installBusyHandler();
+    if(options.walMode)
+    {
+        enableWalMode();
+    }
+    stats.pragmaUsecs = phaseTimer.nsecsElapsed()/1000;
+    phaseTimer.restart();
+    //预处理热点语句 首次执行时不再需要解析sql、生成执行计划
+#ifdef SQLITE_NATIVE_API
+    for(int i=0;isNativeApiAvailable() && i<options.warmupStatements.size();i++)
+    {
+        SqliteStatement statement(&statementCache,options.warmupStatements.at(i));//析构时放入缓存
+        if(statement.isValid())
+        {
+            stats.warmedStatements++;
+        }
+        else
+        {
+            qDebug()<<"warm up statement error:"<<statement.lastError()<<options.warmupStatements.at(i);
+        }
+    }
+#endif
+    stats.warmupUsecs = phaseTimer.nsecsElapsed()/1000;
+    //后台任务需要WAL模式，否则后台连接的读事务会使主连接的写操作等待
+    bool isBackground = isWalMode && databaseName != ":memory:";
+    if(options.backgroundIntegrityCheck && !isBackground)
+    {
+        phaseTimer.restart();
+        stats.isIntegrity = integrityCheck();
+        stats.integrityCheckUsecs = phaseTimer.nsecsElapsed()/1000;
+        emit integrityChecked(stats.isIntegrity);
+    }
+    if(!options.prefetchTables.isEmpty() && !isBackground)
+    {
+        qDebug()<<"prefetch tables skipped: WAL mode is required...";
+    }
+    stats.readyUsecs = totalTimer.nsecsElapsed()/1000;
+    {
+        QMutexLocker locker(&startupMutex);
+        startupTimings = stats;
+    }
+    if(isBackground && (options.backgroundIntegrityCheck || !options.prefetchTables.isEmpty()))
+    {
+        bool isIntegrityCheck = options.backgroundIntegrityCheck;
+        QStringList prefetchTables = options.prefetchTables;
+        startupFuture = QtConcurrent::run([this,databaseName,isIntegrityCheck,prefetchTables](){
+            runStartupTasks(databaseName,isIntegrityCheck,prefetchTables);
+        });
+    }
     return true;
 }
 /*
@@ -86,10 +261,118 @@ void DatabaseManager::closeConnection()
      * 此处警告的根本原因是db有一个有效的数据库连接(isValid()),虽然db在这里无法
      * 析构,但将其置为一个无效的对象也能解决警告的问题
     */
+    startupFuture.waitForFinished();//后台任务使用this，析构前必须结束
+    if(stagedTableCount.load())
+    {
+        disableStaging();//内存中暂存的数据在关闭前写入磁盘
+        {
+            QMutexLocker stagingLocker(&stagingMutex);
+            stagedTables.clear();
+            stagedTableCount.storeRelease(0);
+        }
+        if(stagingTimer)
+        {
+            stagingTimer->stop();
+        }
+    }
+    stagingFlushFuture.waitForFinished();//后台刷新使用当前连接
+    disableChangeNotification();
+#ifdef SQLITE_NATIVE_API
+    statementCache.setHandle(0);//缓存的预处理语句必须在连接关闭前释放
+#endif
     db.close();
     db = QSqlDatabase();//将db置为一个无效的对象
+    isWalMode = false;
     QSqlDatabase::removeDatabase(connectionName);
 }
+/*
+ *@brief:   获取当前连接的数据库名
+ *@date:    2026.10.19
+ *@return:  QString:数据库名(文件路径)，未连接时为空
+ */
+QString DatabaseManager::databaseName()
+{
+    return db.databaseName();
+}
+/*
+ *@brief:   将数据库切换为WAL(预写日志)模式
+ * 默认的回滚日志模式下，读事务和写事务互斥。WAL模式下写操作追加到-wal文件中，
+ * 读事务看到的始终是事务开始时的数据，读写可以并发进行。该设置会持久保存在数据
+ * 库文件中，切换时要求当前连接没有未结束的事务。
+ *@date:    2026.10.19
+ *@return:  返回值为布尔类型，true:成功，false:失败(例如内存数据库)
+ */
+bool DatabaseManager::enableWalMode()
+{
+    if(isWalMode)
+    {
+        return true;
+    }
+    QSqlQuery query(db);//创建sql语句执行对象
+#ifdef MT_SAFE
+    DatabaseLocker locker(&lockManager);//数据库独占锁
+#endif
+    if(!query.exec("pragma journal_mode = WAL;"))
+    {
+        qDebug()<<"pragma journal_mode error:"<<query.lastError();
+        return false;
+    }
+    //pragma返回切换后的日志模式，不支持WAL时(如内存数据库)返回原来的模式
+    if(query.next() && query.value(0).toString().toLower() == "wal")
+    {
+        isWalMode = true;
+        return true;
+    }
+    qDebug()<<"journal mode is not wal:"<<query.value(0);
+    return false;
+}
+/*
+ *@brief:   获取当前连接的页缓存统计
+ *  命中(hits)表示数据页直接从页缓存读取，未命中(misses)表示需要从文件(或内存映射)读取，
+ *  写入(writes)表示写到文件的脏页数。可据此权衡cache_size/mmap_size占用的内存与读取延时。
+ *@date:    2026.10.19
+ *@param:   reset:获取后是否将命中/未命中/写入计数清零
+ *@return:  PageCacheStats:页缓存统计，需要SQLITE_NATIVE_API，不可用时isValid为false
+ */
+PageCacheStats DatabaseManager::pageCacheStats(bool reset)
+{
+    PageCacheStats stats;
+#ifdef SQLITE_NATIVE_API
+    sqlite3 *handle = sqliteHandle();
+    if(!handle)
+    {
+        return stats;
+    }
+    int current = 0;
+    int highwater = 0;
+    int resetFlag = reset ? 1 : 0;
+    if(sqlite3_db_status(handle,SQLITE_DBSTATUS_CACHE_HIT,&current,&highwater,resetFlag) != SQLITE_OK)
+    {
+        return stats;
+    }
+    stats.hits = current;
+    sqlite3_db_status(handle,SQLITE_DBSTATUS_CACHE_MISS,&current,&highwater,resetFlag);
+    stats.misses = current;
+    sqlite3_db_status(handle,SQLITE_DBSTATUS_CACHE_WRITE,&current,&highwater,resetFlag);
+    stats.writes = current;
+    sqlite3_db_status(handle,SQLITE_DBSTATUS_CACHE_USED,&current,&highwater,0);
+    stats.usedBytes = current;
+    stats.isValid = true;
+#else
+    Q_UNUSED(reset);
+#endif
+    return stats;
+}
+/*
+ *@brief:   获取最近一次createSqliteConnection()各阶段的耗时 后台任务结束前对应的耗时为-1
+ *@date:    2026.10.19
+ *@return:  StartupStats:启动耗时统计
+ */
+StartupStats DatabaseManager::startupStats()
+{
+    QMutexLocker locker(&startupMutex);
+    return startupTimings;
+}
 /*
  *@brief:   数据库完整性检测(结构,格式,数据记录)
  * SQLite数据库损坏的可能性很低，但是不排除某些情况下(异常断电等)因外部程序或硬件操作系统
@@ -167,7 +450,6 @@ bool DatabaseManager::createTable(QString tableName, QList<QString> &columnNames
     /*sqlite 的sql语句在涉及到表名和列名时,默认是不支持表列名以数字开头或者含有特殊
      字符的(会有语法错误)，如果非要用，则可以给sql语句中的表列名加上单引号(sqlite)或
     者倒引号。这里为了表列名尽量标准化，没有进行处理*/
-    QSqlQuery query(db);//创建sql语句执行对象
     QString createSql = QString("create table if not exists %1(").arg(tableName);
     for(int i=0; i<columnCount; i++)
     {
@@ -192,15 +474,9 @@ bool DatabaseManager::createTable(QString tableName, QList<QString> &columnNames
      */
     //db.tables();//相当于刷新当前连接的数据库中的用户表
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec(createSql))
-    {
-        qDebug()<<"create table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<createSql;
-        return false;
-    }
-    return true;
+    return execSql(createSql,QVariantList(),"create table error:");
 }
 /*
  *@brief:   建表
@@ -212,17 +488,10 @@ bool DatabaseManager::createTable(QString tableName, QList<QString> &columnNames
 bool DatabaseManager::createTable(QString createSql)
 {
     db.tables();//当前连接的数据库中的用户表
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(createSql))
-    {
-        qDebug()<<"create table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<createSql;
-        return false;
-    }
-    return true;
+    return execSql(createSql,QVariantList(),"create table error:");
 }
 /*
  *@brief:   修改表结构 sqlite对该语句的支持有限，仅可以修改表名和添加字段，例：
@@ -235,16 +504,14 @@ bool DatabaseManager::createTable(QString createSql)
  */
 bool DatabaseManager::alterTable(QString alterSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(alterSql))
+    if(!execSql(alterSql,QVariantList(),"alter table error:"))
     {
-        qDebug()<<"alter table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<alterSql;
         return false;
     }
+    refreshMirror(QString());//表结构可能变化，重新加载所有镜像
     return true;
 }
 /*
@@ -256,18 +523,32 @@ bool DatabaseManager::alterTable(QString alterSql)
  */
 bool DatabaseManager::dropTable(QString tableName)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     //sqlite不支持使用RESTRICT和CASCADE(级联),默认级联删除
     QString dropSql = QString("drop table if exists %1;").arg(tableName);
-    QSqlQuery query(db);//创建sql语句执行对象
+    if(isStagedTable(tableName))
+    {
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+        DatabaseLocker locker(&lockManager);//同时修改暂存表列表和内存数据库，加数据库独占锁
 #endif
-    if(!query.exec(dropSql))
+        //暂存表也要删除并移出列表，否则之后每次刷新都因原表不存在而失败
+        if(!execSql(dropSql,QVariantList(),"drop table error:") || !unstageTable(tableName))
+        {
+            return false;
+        }
+    }
+    else
     {
-        qDebug()<<"drop table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<dropSql;
-        return false;
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
+#endif
+        if(!execSql(dropSql,QVariantList(),"drop table error:"))
+        {
+            return false;
+        }
     }
+    unpinTable(tableName);
+    notifyTableCleared(tableName);
     return true;
 }
 /*
@@ -280,6 +561,10 @@ bool DatabaseManager::dropTable(QString tableName)
  */
 bool DatabaseManager::copyTable(QString srcTableName, QString desTableName)
 {
+    /*暂存表先刷新到磁盘:onlyCopyTable()只复制磁盘上的源表，目的表清空前也要先写入。
+     *刷新需要对所有暂存表加写锁，必须在加表锁之前完成，加锁后不能再刷新(见copyTableDelta())*/
+    prepareStagedModify(srcTableName);
+    prepareStagedModify(desTableName);
 #ifdef MT_SAFE
     /*复制表的操作对于sqlite而言并不是"1"条事务操作，因为这里需要先清空数据
      * (或者新建表),然后再插入新数据。所以即便sqlite3本身是线程安全的，但也只
@@ -289,21 +574,26 @@ bool DatabaseManager::copyTable(QString srcTableName, QString desTableName)
      * 所以这里利用读写锁将整个复制表的操作模拟成一个原子操作，避免被其他
      * 线程打断出问题。
      *
-     * 因为这个方法中调用的函数也加了读写锁，所以在readWriteLock定义时，添加
-     * 了QreadWriteLock::Recursive属性，允许对同一个线程加锁多次，否则会引起
-     * 死锁。但经过测试发现Recursive属性只允许同一线程对相同的锁(读或写)加锁
-     * 多次，而如果先加了写锁，再加读锁就会锁死。所以该方法中调用的函数不能加
-     * 读锁，isExistTableForCopyTable()就是为了避免该问题而创建的。
+     * 这里只对源表加读锁、目的表加写锁(由锁管理器按表名顺序加锁，避免与反向
+     * 复制的操作交叉死锁)，其他表的读写不受影响。
+     *
+     * 因为这个方法中调用的函数也加了表锁，所以表锁定义时添加了QReadWriteLock::
+     * Recursive属性，允许对同一个线程加锁多次，否则会引起死锁。但经过测试发现
+     * Recursive属性只允许同一线程对相同的锁(读或写)加锁多次，而如果先加了写锁，
+     * 再加读锁就会锁死。所以该方法中调用的函数不能对目的表加读锁，也不能升级为
+     * 数据库独占锁，isExistTableForCopyTable()和createTableForCopyTable()就是为了
+     * 避免该问题而创建的。
     */
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,QStringList()<<srcTableName,QStringList()<<desTableName);//源表读锁 目的表写锁
 #endif
-    //目的表存在，则清空所有数据，但保留原结构
+    //目的表存在，则清空所有数据，但保留原结构 不调用deleteTable()，它会在持有表锁时刷新暂存表
     if(isExistTableForCopyTable(desTableName))
     {
-        if(!deleteTable(desTableName))
+        if(!execSql(QString("delete from %1;").arg(desTableName),QVariantList(),"delete table error:"))
         {
             return false;
         }
+        notifyTableCleared(desTableName);
     }
     //目的表不存在，则创建表结构
     else
@@ -311,7 +601,7 @@ bool DatabaseManager::copyTable(QString srcTableName, QString desTableName)
         //获取源表的建表语句
         QString createTableSql = getCreateTableSqlForCopyTable("sqlite_master",srcTableName);
         createTableSql.replace(srcTableName,desTableName);//替换成新表名
-        if(!createTable(createTableSql))
+        if(!createTableForCopyTable(createTableSql))
         {
             return false;
         }
@@ -321,6 +611,7 @@ bool DatabaseManager::copyTable(QString srcTableName, QString desTableName)
     {
         return false;
     }
+    refreshMirror(desTableName);
     return true;
 }
 /*
@@ -334,8 +625,9 @@ bool DatabaseManager::copyTable(QString srcTableName, QString desTableName)
  */
 bool DatabaseManager::copyTable(QString srcDbName, QString srcTableName, QString desTableName)
 {
+    prepareStagedModify(desTableName);//暂存表先刷新到磁盘 原因同上
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁 　原因同上
+    DatabaseLocker locker(&lockManager);//数据库独占锁　原因同上
 #endif
     QString aliasName = "sourceDB";//附加数据库别名
     /*目的表如果存在则清空所有数据，但保留原结构。
@@ -344,10 +636,11 @@ bool DatabaseManager::copyTable(QString srcDbName, QString srcTableName, QString
      */
     if(isExistTableForCopyTable(desTableName))
     {
-        if(!deleteTable(desTableName))
+        if(!execSql(QString("delete from %1;").arg(desTableName),QVariantList(),"delete table error:"))
         {
             return false;
         }
+        notifyTableCleared(desTableName);
         //附加数据库
         if(!attachDB(srcDbName,aliasName))
         {
@@ -385,6 +678,7 @@ bool DatabaseManager::copyTable(QString srcDbName, QString srcTableName, QString
     {
         return false;
     }
+    refreshMirror(desTableName);
     return true;
 }
 /*
@@ -418,30 +712,20 @@ bool DatabaseManager::insertTable(QString tableName, QVariantList &rowValues, QL
         }
     }
     //为sql语句添加占位符
-    for(int i=0;i<rowValuesNumber;i++)
-    {
-        bindValuesStr.append("?");
-        if(i != rowValuesNumber-1)
-        {
-            bindValuesStr.append(",");
-        }
-    }
-    QString insertSql=QString("insert into %1%2 values(%3);").arg(tableName,columnNamesStr,bindValuesStr);
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(insertSql);
+    bindValuesStr = getBindValuesStr(rowValuesNumber);
+    QString insertSql=QString("insert into %1%2 values(%3);").arg(stagingWriteTable(tableName),columnNamesStr,bindValuesStr);
+    prepareStagedWrite(tableName);
+    QVariantList bindValues = compressValues(tableName,columnNames,rowValues);//压缩在加锁之前完成
     //绑定占位符 注:mysql5 因为没有提供控制输入输出参数的API,所以不能使用占位符
-    for(int i=0;i<rowValuesNumber;i++)
-    {
-        query.addBindValue(rowValues.at(i));
-    }
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!execSql(insertSql,bindValues,"insert table error:"))
     {
-        qDebug()<<"insert table error:"<<query.lastError();
         return false;
     }
+    addStagedRows(tableName,1);
+    refreshMirrorRow(tableName,columnNames,rowValues);
     return true;
 }
 /*
@@ -480,62 +764,39 @@ bool DatabaseManager::insertBatchTable(QString tableName, QList<QVariantList> &c
         }
     }
     //为sql语句添加占位符
-    for(int i=0;i<columnNumber;i++)
-    {
-        bindValuesStr.append("?");
-        if(i != columnNumber-1)
-        {
-            bindValuesStr.append(",");
-        }
-    }
-    QString insertSql=QString("insert into %1%2 values(%3);").arg(tableName,columnNamesStr,bindValuesStr);
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(insertSql);
-    //绑定占位符
-    for(int i=0;i<columnNumber;i++)
-    {
-        //批量插入时，允许使用QVariantList类型作为参数，一次绑定多个元组同一字段的数据
-        query.addBindValue(columnValues.at(i));
-    }
+    bindValuesStr = getBindValuesStr(columnNumber);
+    QString insertSql=QString("insert into %1%2 values(%3);").arg(stagingWriteTable(tableName),columnNamesStr,bindValuesStr);
+    int rowCount = columnValues.isEmpty() ? 0 : columnValues.first().size();
+    prepareStagedWrite(tableName);
+    QList<QVariantList> bindColumnValues = compressColumnValues(tableName,columnNames,columnValues);
     /*事务属于原子性操作，同一个时刻只能存在一个，多线程时如果一个线程正在使用事务，另
-     *一个线程就不能成功开启事务模式。
+     *一个线程就不能成功开启事务模式(beginTransaction()通过事务互斥让后者等待)。
      *另外一旦通过transaction()成功开启事务后，必须通过commit()或者rollback()结束事务后，
      *才能再次开启成功，否则无法再次开启事务。
      */
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(db.transaction())//成功开启事务操作 原子性操作，commit()之前数据一直在内存中
+    /*不能开启事务时不再退回逐条自动提交:那样的语句会混入其他线程的事务，随它回滚。
+     *beginTransaction()会等待其他线程的事务结束，失败只可能是数据库本身的错误*/
+    if(!beginTransaction("insert batch table transaction error:"))//原子性操作，commit()之前数据一直在内存中
     {
-        qDebug()<<"transaction operation;";
-        //真正的费时操作是下面这句话，取决于批量插入数据的多少
-        if(!query.execBatch())
-        {
-            qDebug()<<"insert batch table error:"<<query.lastError();
-            db.rollback();//批量插入失败，回滚到之前的状态
-            return false;
-        }
-        //在批量插入数据时，提交事务并不费时
-        if(!db.commit())//提交事务
-        {
-            qDebug()<<"insert batch table transaction error:"<<db.lastError();
-            return false;
-        }
-        else
-        {
-            return true;
-        }
+        return false;
     }
-    else //按照普通插入方式写数据，sqlite的特点是每执行一条sql语句实则进行一次IO操作，效率低
+    //真正的费时操作是下面这句话，取决于批量插入数据的多少
+    if(!execBatchSql(insertSql,bindColumnValues,"insert batch table error:"))
     {
-        qDebug()<<"not transaction operation";
-        if(!query.execBatch())
-        {
-            qDebug()<<"insert batch table error:"<<query.lastError();
-            return false;
-        }
-        return true;
+        rollbackTransaction();//批量插入失败，回滚到之前的状态
+        return false;
+    }
+    //在批量插入数据时，提交事务并不费时
+    if(!commitTransaction("insert batch table transaction error:"))//提交事务
+    {
+        return false;
     }
+    addStagedRows(tableName,rowCount);
+    refreshMirror(tableName);
+    return true;
 }
 /*
  *@brief:   插入数据
@@ -546,15 +807,14 @@ bool DatabaseManager::insertBatchTable(QString tableName, QList<QVariantList> &c
  */
 bool DatabaseManager::insertTable(QString insertSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(insertSql))
+    if(!execSql(insertSql,QVariantList(),"insert table error:"))
     {
-        qDebug()<<"insert table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(QString());//无法确定修改的表，重新加载所有镜像
     return true;
 }
 /*
@@ -569,6 +829,7 @@ bool DatabaseManager::insertTable(QString insertSql)
  */
 bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames, QVariantList &rowValues, QString whereSql)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     int columnCount = columnNames.size();
     //保证修改的字段名和值数量一致
     if(columnCount != rowValues.size())
@@ -595,21 +856,15 @@ bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames
         updateSql.append(" where "+whereSql+";");
     }
     //执行Sql命令
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(updateSql);
-    //绑定占位符
-    for(int i=0;i<columnCount;i++)
-    {
-        query.addBindValue(rowValues.at(i));
-    }
+    QVariantList bindValues = compressValues(tableName,columnNames,rowValues);
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!execSql(updateSql,bindValues,"update table error:"))
     {
-        qDebug()<<"update table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName);
     return true;
 }
 /*
@@ -625,6 +880,7 @@ bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames
  */
 bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames, QVariantList &rowValues, QString whereColName, QVariant whereColValue)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     int columnCount = columnNames.size();
     //保证修改的字段名和值数量一致
     if(columnCount != rowValues.size())
@@ -643,22 +899,17 @@ bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames
     }
     QString updateSql = QString("update %1 %2 where %3=?;").arg(tableName,setColumnValue,whereColName);
     //执行Sql命令
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(updateSql);
     //绑定占位符
-    for(int i=0;i<columnCount;i++)
-    {
-        query.addBindValue(rowValues.at(i));
-    }
-    query.addBindValue(whereColValue);
+    QVariantList bindValues = compressValues(tableName,columnNames,rowValues);
+    bindValues<<whereColValue;
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!execSql(updateSql,bindValues,"update table error:"))
     {
-        qDebug()<<"update table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName,whereColName,QVariantList()<<whereColValue,columnNames);
     return true;
 }
 /*
@@ -673,6 +924,7 @@ bool DatabaseManager::updateTable(QString tableName, QList<QString> &columnNames
  */
 bool DatabaseManager::updateTable(QString tableName, QString columnName, QVariant rowValue, QString whereSql)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     QString updateSql = QString("update %1 set %2 = ?").arg(tableName,columnName);
     if(whereSql.isEmpty())
     {
@@ -683,17 +935,15 @@ bool DatabaseManager::updateTable(QString tableName, QString columnName, QVarian
         updateSql.append(" where "+whereSql+";");
     }
     //执行Sql命令
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(updateSql);
-    query.addBindValue(rowValue);
+    QVariantList bindValues = compressValues(tableName,QList<QString>()<<columnName,QVariantList()<<rowValue);
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!execSql(updateSql,bindValues,"update table error:"))
     {
-        qDebug()<<"update table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName);
     return true;
 }
 /*
@@ -709,20 +959,19 @@ bool DatabaseManager::updateTable(QString tableName, QString columnName, QVarian
  */
 bool DatabaseManager::updateTable(QString tableName, QString columnName, QVariant rowValue, QString whereColName, QVariant whereColValue)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     QString updateSql = QString("update %1 set %2 = ? where %3=?;").arg(tableName,columnName,whereColName);
     //执行Sql命令
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(updateSql);
-    query.addBindValue(rowValue);
-    query.addBindValue(whereColValue);
+    QVariantList bindValues = compressValues(tableName,QList<QString>()<<columnName,QVariantList()<<rowValue);
+    bindValues<<whereColValue;
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!execSql(updateSql,bindValues,"update table error:"))
     {
-        qDebug()<<"update table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName,whereColName,QVariantList()<<whereColValue,QList<QString>()<<columnName);
     return true;
 }
 /*
@@ -734,15 +983,14 @@ bool DatabaseManager::updateTable(QString tableName, QString columnName, QVarian
  */
 bool DatabaseManager::updateTable(QString updateSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(updateSql))
+    if(!execSql(updateSql,QVariantList(),"update table error:"))
     {
-        qDebug()<<"update table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(QString());//无法确定修改的表，重新加载所有镜像
     return true;
 }
 /*
@@ -755,7 +1003,7 @@ bool DatabaseManager::updateTable(QString updateSql)
  */
 bool DatabaseManager::deleteTable(QString tableName, QString whereSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     QString deleteSql = QString("delete from %1").arg(tableName);
     if(whereSql.isEmpty())
     {
@@ -766,13 +1014,17 @@ bool DatabaseManager::deleteTable(QString tableName, QString whereSql)
         deleteSql.append(" where "+whereSql+";");
     }
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec(deleteSql))
+    if(!execSql(deleteSql,QVariantList(),"delete table error:"))
     {
-        qDebug()<<"delete table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName);
+    if(whereSql.isEmpty())
+    {
+        notifyTableCleared(tableName);
+    }
     return true;
 }
 /*
@@ -786,20 +1038,79 @@ bool DatabaseManager::deleteTable(QString tableName, QString whereSql)
  */
 bool DatabaseManager::deleteTable(QString tableName, QString whereColName, QVariant whereColValue)
 {
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
     QString deleteSql = QString("delete from %1 where %2=?;").arg(tableName,whereColName);
-    QSqlQuery query(db);//创建sql语句执行对象
-    query.prepare(deleteSql);
-    query.addBindValue(whereColValue);
+    QVariantList bindValues;
+    bindValues<<whereColValue;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
+#endif
+    if(!execSql(deleteSql,bindValues,"delete table error:"))
+    {
+        return false;
+    }
+    refreshMirror(tableName,whereColName,QVariantList()<<whereColValue);
+    return true;
+}
+/*
+ *@brief:  按键值列表批量删除数据  针对where条件为columnName in (colnumValues);
+ *  键值列表按BATCH_KEY_CHUNK_SIZE分段生成"in(?,?...)"语句，整个删除过程只加一次锁，
+ *  并放在一个事务内执行，避免逐条删除时每条语句一次IO的开销。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   whereColName:　where条件的列名
+ *@param:   whereColValues:　where条件的列值列表
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::deleteBatchTable(QString tableName, QString whereColName, QVariantList whereColValues)
+{
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
+    int keyCount = whereColValues.size();
+    if(!keyCount)
+    {
+        return true;
+    }
+    QString deleteSqlFormat = QString("delete from %1 where %2 in (%3);").arg(tableName,whereColName);
+    //完整分段的语句只生成一次，原生接口下相同的语句只预处理一次(语句缓存)
+    QString chunkDeleteSql = deleteSqlFormat.arg(getBindValuesStr(BATCH_KEY_CHUNK_SIZE));
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
 #endif
-    if(!query.exec())
+    if(!beginTransaction("delete batch table transaction error:"))
+    {
+        return false;
+    }
+    for(int start=0;start<keyCount;start+=BATCH_KEY_CHUNK_SIZE)
+    {
+        int chunkSize = qMin(BATCH_KEY_CHUNK_SIZE,keyCount-start);
+        QString deleteSql = chunkDeleteSql;
+        if(chunkSize != BATCH_KEY_CHUNK_SIZE)//最后不足一段的单独生成
+        {
+            deleteSql = deleteSqlFormat.arg(getBindValuesStr(chunkSize));
+        }
+        if(!execSql(deleteSql,whereColValues.mid(start,chunkSize),"delete batch table error:"))
+        {
+            rollbackTransaction();//批量删除失败，回滚到之前的状态
+            return false;
+        }
+    }
+    if(!commitTransaction("delete batch table transaction error:"))//提交事务
     {
-        qDebug()<<"delete table error:"<<query.lastError();
         return false;
     }
+    refreshMirror(tableName,whereColName,whereColValues);
     return true;
 }
+/*
+ *@brief:   获取当前线程最近一次插入、修改或删除语句影响的行数 用于区分"执行成功但没有匹配
+ * 的行"(如updateTable()的where条件没有匹配)与真正写入的情况
+ *@date:    2026.10.19
+ *@return:  int:影响的行数 执行失败时为0
+ */
+int DatabaseManager::lastRowsAffected()
+{
+    return threadRowsAffected;
+}
 /*
  *@brief:   查询单行单列的某一数据
  *@author:  缪庆瑞
@@ -811,21 +1122,18 @@ bool DatabaseManager::deleteTable(QString tableName, QString whereColName, QVari
  */
 QVariant DatabaseManager::selectSingleColData(QString tableName, QString columnName, QString whereSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
-    QString selectSql = QString("select %1 from %2 where %3;").arg(columnName,tableName,whereSql);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    QString selectSql = QString("select %1 from %2 where %3;").arg(columnName,stagingReadSource(tableName),whereSql);
+    QVariantList values;
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec(selectSql))
+    if(!execSelect(selectSql,QVariantList(),values,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return QVariant();//返回无效的数据
     }
-    if(query.next())//指向结果集的第一条记录
+    if(!values.isEmpty())//结果集的第一条记录
     {
-        return query.value(0);
+        return values.first();
     }
     else
     {
@@ -845,23 +1153,29 @@ QVariant DatabaseManager::selectSingleColData(QString tableName, QString columnN
  */
 QVariant DatabaseManager::selectSingleColData(QString tableName, QString columnName, QString whereColName, QVariant whereColValue)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
-    QString selectSql = QString("select %1 from %2 where %3=?;").arg(columnName,tableName,whereColName);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
-    query.prepare(selectSql);
-    query.addBindValue(whereColValue);
+    QVariantList mirrorValues;
+    if(selectMirror(tableName,QList<QString>()<<columnName,whereColName,whereColValue,mirrorValues))
+    {
+        if(mirrorValues.isEmpty())
+        {
+            qDebug()<<"no select record:"<<tableName<<whereColName<<whereColValue;
+        }
+        return mirrorValues.value(0);//常驻内存的表，直接从镜像返回 不存在时返回无效的数据
+    }
+    QString selectSql = QString("select %1 from %2 where %3=?;").arg(columnName,stagingReadSource(tableName),whereColName);
+    QVariantList bindValues;
+    bindValues<<whereColValue;
+    QVariantList values;
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec())
+    if(!execSelect(selectSql,bindValues,values,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql<<whereColValue;
         return QVariant();//返回无效的数据
     }
-    if(query.next())//指向结果集的第一条记录
+    if(!values.isEmpty())//结果集的第一条记录
     {
-        return query.value(0);
+        return values.first();
     }
     else
     {
@@ -891,32 +1205,20 @@ QVariantList DatabaseManager::selectMultiColData(QString tableName, QList<QStrin
     {
         columnNamesStr.append("*");
     }
-    QSqlQuery query(db);//创建sql语句执行对象
-    QString selectSql = QString("select %1 from %2 where %3;").arg(columnNamesStr,tableName,whereSql);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    QString selectSql = QString("select %1 from %2 where %3;").arg(columnNamesStr,stagingReadSource(tableName),whereSql);
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec(selectSql))
+    //只取结果集的第一条记录
+    if(!execSelect(selectSql,QVariantList(),valueList,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return valueList;//返回无效的数据
     }
-    if(query.next())//指向结果集的第一条记录
-    {
-        int count = query.record().count();//结果集一条记录的字段数
-        for(int i=0;i<count;i++)
-        {
-            valueList.append(query.value(i));
-        }
-        return valueList;
-    }
-    else
+    if(valueList.isEmpty())
     {
         qDebug()<<"no select record:"<<selectSql;
-        return valueList;//返回无效的数据
     }
+    return valueList;
 }
 /*
  *@brief:   查询单行多列的数据   针对where条件为columnName = colnumValue;
@@ -931,6 +1233,14 @@ QVariantList DatabaseManager::selectMultiColData(QString tableName, QList<QStrin
 QVariantList DatabaseManager::selectMultiColData(QString tableName, QList<QString> columnNames, QString whereColName, QVariant whereColValue)
 {
     QList<QVariant> valueList;
+    if(selectMirror(tableName,columnNames,whereColName,whereColValue,valueList))
+    {
+        if(valueList.isEmpty())
+        {
+            qDebug()<<"no select record:"<<tableName<<whereColName<<whereColValue;
+        }
+        return valueList;//常驻内存的表，直接从镜像返回
+    }
     QString columnNamesStr;
     //列名非空，查询对应字段数据
     if(!columnNames.isEmpty())
@@ -941,61 +1251,107 @@ QVariantList DatabaseManager::selectMultiColData(QString tableName, QList<QStrin
     {
         columnNamesStr.append("*");
     }
-    QSqlQuery query(db);//创建sql语句执行对象
-    QString selectSql = QString("select %1 from %2 where %3=?;").arg(columnNamesStr,tableName,whereColName);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
-    query.prepare(selectSql);
-    query.addBindValue(whereColValue);
+    QString selectSql = QString("select %1 from %2 where %3=?;").arg(columnNamesStr,stagingReadSource(tableName),whereColName);
+    QVariantList bindValues;
+    bindValues<<whereColValue;
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec())
+    //只取结果集的第一条记录
+    if(!execSelect(selectSql,bindValues,valueList,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql<<whereColValue;
         return valueList;//返回无效的数据
     }
-    if(query.next())//指向结果集的第一条记录
-    {
-        int count = query.record().count();//结果集一条记录的字段数
-        for(int i=0;i<count;i++)
-        {
-            valueList.append(query.value(i));
-        }
-        return valueList;
-    }
-    else
+    if(valueList.isEmpty())
     {
         qDebug()<<"no select record:"<<selectSql<<whereColValue;
-        return valueList;//返回无效的数据
     }
+    return valueList;
 }
 /*
- *@brief:   查询多行单列的某一数据
- * sqlite3默认会对查询的主键字段按升序排列，其他情况如果不显式使用order by
- * 的话，则按照插入顺序排列。
- * 若要显式使用order by，可以将其放在该函数的whereSql函参中，如果是无条件
- * 查询且要显式排序，whereSql可以这样写："1=1 order by columName ASC/DESC"
- *@author:  缪庆瑞
- *@date:    2018.8.29
+ *@brief:   按键值列表批量查询单行多列的数据   针对where条件为columnName in (colnumValues);
+ *  与deleteBatchTable()相同，键值列表分段生成"in(?,?...)"语句，整个查询过程只加一次锁。
+ *  查询时会在结果列前额外查询whereColName列，用于建立键值到行数据的映射。
+ *@date:    2026.10.19
  *@param:   tableName: 表名
- *@param:   columnName:查询的列名(字段名)
- *@param:   isDistinct:是否对查询结果去重　默认true
- *@parma:   whereSql:条件　例如：Sno='1001'　为空则表示无条件查询某列
- *@return:  返回值为QVariantList类型,由上层根据字段类型自行转换
+ *@param:   columnNames:查询的多个列名(字段名)　为空则查询整行数据
+ *@param:   whereColName:　where条件的列名  此处为主键字段或唯一性字段
+ *@param:   whereColValues:　where条件的列值列表
+ *@return:  返回值为QHash<QString,QVariantList>类型,键为whereColName列值的字符串形式(QVariant
+ *  不支持作为QHash的键),值为该行对应columnNames的数据,未查到的键值不会出现在结果中
  */
-QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString columnName, bool isDistinct, QString whereSql)
+QHash<QString,QVariantList> DatabaseManager::selectBatchMultiColData(QString tableName, QList<QString> columnNames, QString whereColName, QVariantList whereColValues)
+{
+    QHash<QString,QVariantList> valueHash;
+    int keyCount = whereColValues.size();
+    if(!keyCount)
+    {
+        return valueHash;
+    }
+    QString columnNamesStr;
+    //列名非空，查询对应字段数据
+    if(!columnNames.isEmpty())
+    {
+        columnNamesStr.append(QStringList(columnNames).join(","));
+    }
+    else//列名为空，则查询整行数据
+    {
+        columnNamesStr.append("*");
+    }
+    QString selectSqlFormat = QString("select %1,%2 from %3 where %4 in (%5);")
+            .arg(whereColName,columnNamesStr,stagingReadSource(tableName),whereColName);
+    //完整分段的语句只生成一次，原生接口下相同的语句只预处理一次(语句缓存)
+    QString chunkSelectSql = selectSqlFormat.arg(getBindValuesStr(BATCH_KEY_CHUNK_SIZE));
+    valueHash.reserve(keyCount);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+    for(int start=0;start<keyCount;start+=BATCH_KEY_CHUNK_SIZE)
+    {
+        int chunkSize = qMin(BATCH_KEY_CHUNK_SIZE,keyCount-start);
+        QString selectSql = chunkSelectSql;
+        if(chunkSize != BATCH_KEY_CHUNK_SIZE)//最后不足一段的单独生成
+        {
+            selectSql = selectSqlFormat.arg(getBindValuesStr(chunkSize));
+        }
+        QVariantList values;
+        int count = 0;//结果集一条记录的字段数(含键值列)
+        if(!execSelect(selectSql,whereColValues.mid(start,chunkSize),values,&count,-1,"select batch table error:"))
+        {
+            return QHash<QString,QVariantList>();//返回空的映射
+        }
+        for(int row=0;row+count<=values.size() && count>0;row+=count)
+        {
+            valueHash.insert(values.at(row).toString(),values.mid(row+1,count-1));
+        }
+    }
+    return valueHash;
+}
+/*
+ *@brief:   查询多行单列的某一数据
+ * sqlite3默认会对查询的主键字段按升序排列，其他情况如果不显式使用order by
+ * 的话，则按照插入顺序排列。
+ * 若要显式使用order by，可以将其放在该函数的whereSql函参中，如果是无条件
+ * 查询且要显式排序，whereSql可以这样写："1=1 order by columName ASC/DESC"
+ *@author:  缪庆瑞
+ *@date:    2018.8.29
+ *@param:   tableName: 表名
+ *@param:   columnName:查询的列名(字段名)
+ *@param:   isDistinct:是否对查询结果去重　默认true
+ *@parma:   whereSql:条件　例如：Sno='1001'　为空则表示无条件查询某列
+ *@return:  返回值为QVariantList类型,由上层根据字段类型自行转换
+ */
+QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString columnName, bool isDistinct, QString whereSql)
 {
     QList<QVariant> recordList;
-    QSqlQuery query(db);//创建sql语句执行对象
     QString selectSql;
     if(isDistinct)//去重
     {
-        selectSql = QString("select distinct %1 from %2").arg(columnName,tableName);
+        selectSql = QString("select distinct %1 from %2").arg(columnName,stagingReadSource(tableName));
     }
     else
     {
-        selectSql = QString("select %1 from %2").arg(columnName,tableName);
+        selectSql = QString("select %1 from %2").arg(columnName,stagingReadSource(tableName));
     }
     if(whereSql.isEmpty())
     {
@@ -1005,19 +1361,13 @@ QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString co
     {
         selectSql.append(" where "+whereSql+";");
     }
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec(selectSql))
-    {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
-        return recordList;//返回空的列表
-    }
-    while(query.next())//指向结果集的第一条记录
+    //单列查询时结果集的数据即为每行的数据
+    if(!execSelect(selectSql,QVariantList(),recordList,0,-1,"select table error:"))
     {
-        recordList.append(query.value(0));
+        return QList<QVariant>();//返回空的列表
     }
     return recordList;
 }
@@ -1038,33 +1388,189 @@ QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString co
 QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString columnName, QString whereColName, QVariant whereColValue, bool isDistinct)
 {
     QList<QVariant> recordList;
-    QSqlQuery query(db);//创建sql语句执行对象
     QString selectSql;
     if(isDistinct)//去重
     {
-        selectSql = QString("select distinct %1 from %2 where %3=?;").arg(columnName,tableName,whereColName);
+        selectSql = QString("select distinct %1 from %2 where %3=?;").arg(columnName,stagingReadSource(tableName),whereColName);
     }
     else
     {
-        selectSql = QString("select %1 from %2 where %3=?;").arg(columnName,tableName,whereColName);
+        selectSql = QString("select %1 from %2 where %3=?;").arg(columnName,stagingReadSource(tableName),whereColName);
+    }
+    QVariantList bindValues;
+    bindValues<<whereColValue;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+    //单列查询时结果集的数据即为每行的数据
+    if(!execSelect(selectSql,bindValues,recordList,0,-1,"select table error:"))
+    {
+        return QList<QVariant>();//返回空的列表
+    }
+    return recordList;
+}
+/*
+ *@brief:   查询多行多列的数据到内存池结果集
+ *  结果集在查询前会被reset()，复用上一次查询分配的内存块。对于数据量较大的查询，
+ *  可以用同一个结果集对象反复查询，避免每个单元格分配一次QVariant。
+ *  要显式使用order by，可以将其放在whereSql中，无条件查询时可写成"1=1 order by id"
+ *@date:    2026.10.19
+ *@param:   resultSet:保存查询结果的结果集
+ *@param:   tableName: 表名
+ *@param:   columnNames:查询的多个列名(字段名)　为空则查询整行数据
+ *@param:   whereSql:条件　例如：Sno='1001'　为空则表示无条件查询
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::selectResultSet(ArenaResultSet &resultSet, QString tableName, QList<QString> columnNames, QString whereSql)
+{
+    resultSet.reset();
+    QString columnNamesStr;
+    //列名非空，查询对应字段数据
+    if(!columnNames.isEmpty())
+    {
+        columnNamesStr.append(QStringList(columnNames).join(","));
+    }
+    else//列名为空，则查询整行数据
+    {
+        columnNamesStr.append("*");
+    }
+    QString selectSql = QString("select %1 from %2").arg(columnNamesStr,stagingReadSource(tableName));
+    if(whereSql.isEmpty())
+    {
+        selectSql.append(";");
+    }
+    else
+    {
+        selectSql.append(" where "+whereSql+";");
     }
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
-    query.prepare(selectSql);
-    query.addBindValue(whereColValue);
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+    BusyAccessScope busyScope(ReadAccess);
+#ifdef SQLITE_NATIVE_API
+    //原生接口直接按列类型写入结果集，不经过QVariant 有压缩列时需要先解压，走下面的QSqlQuery
+    if(isNativeApiAvailable() && !isDecompressEnabled.load())
+    {
+        SqliteStatement statement(&statementCache,selectSql);
+        resultSet.reset(statement.columnCount());
+        while(statement.next())
+        {
+            statement.appendRowTo(resultSet);
+        }
+        if(!statement.isValid() || statement.hasError())
+        {
+            qDebug()<<"select table error:"<<statement.lastError();
+            qDebug()<<"error sql:"<<selectSql;
+            resultSet.reset();
+            return false;
+        }
+        return true;
+    }
 #endif
-    if(!query.exec())
+    QSqlQuery query(db);//创建sql语句执行对象
+    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    if(!query.exec(selectSql))
     {
         qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql<<whereColValue;
-        return recordList;//返回空的列表
+        qDebug()<<"error sql:"<<selectSql;
+        return false;
+    }
+    int count = query.record().count();//结果集一条记录的字段数
+    resultSet.reset(count);
+    bool isDecompress = isDecompressEnabled.load();
+    QVariantList rowValues;
+    while(query.next())
+    {
+        rowValues.clear();
+        for(int i=0;i<count;i++)
+        {
+            rowValues.append(query.value(i));
+        }
+        if(isDecompress)
+        {
+            decompressValues(rowValues,0);
+        }
+        for(int i=0;i<count;i++)
+        {
+            resultSet.appendVariant(rowValues.at(i));
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   按游标(键值)分页查询多行多列数据 seek分页:where orderColumn > afterKey order by
+ * orderColumn limit pageSize，借助orderColumn上的索引直接定位到上一页的结尾，任意一页的代价
+ * 都相同。而limit/offset分页需要先扫描并丢弃offset行，越往后的页越慢。
+ * 注:1.orderColumnName需要有索引(或为主键)且值唯一，否则值相同的行可能跨页时被跳过。
+ *    2.whereSql只能是过滤条件，不能包含order by/limit等子句。
+ *@date:    2026.10.19
+ *@param:   rows:返回的数据 每个元素为一行
+ *@param:   nextKey:返回下一页的游标(本页最后一行的orderColumn值)，没有下一页时为无效的数据
+ *@param:   tableName: 表名
+ *@param:   columnNames:查询的列名 为空则查询整行数据
+ *@param:   orderColumnName:排序及游标列
+ *@param:   afterKey:上一页返回的游标 无效的数据表示查询第一页
+ *@param:   pageSize:每页的行数
+ *@param:   whereSql:附加的过滤条件
+ *@param:   isDescending:是否按降序分页
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::selectPage(QList<QVariantList> &rows, QVariant &nextKey, QString tableName, QList<QString> columnNames,
+                                 QString orderColumnName, QVariant afterKey, int pageSize, QString whereSql, bool isDescending)
+{
+    rows.clear();
+    nextKey = QVariant();
+    if(pageSize <= 0)
+    {
+        qDebug()<<"select page error: invalid page size..."<<pageSize;
+        return false;
     }
-    while(query.next())//指向结果集的第一条记录
+    QString columnNamesStr = columnNames.isEmpty() ? QString("*") : QStringList(columnNames).join(",");
+    //在结果列后额外查询游标列，查询的列中不包含游标列时也能得到下一页的游标
+    QString selectSql = QString("select %1,%2 from %3").arg(columnNamesStr,orderColumnName,stagingReadSource(tableName));
+    QStringList conditions;
+    QVariantList bindValues;
+    if(!whereSql.isEmpty())
     {
-        recordList.append(query.value(0));
+        conditions.append("("+whereSql+")");
     }
-    return recordList;
+    if(afterKey.isValid())
+    {
+        conditions.append(QString("%1 %2 ?").arg(orderColumnName,isDescending ? "<" : ">"));
+        bindValues<<afterKey;
+    }
+    if(!conditions.isEmpty())
+    {
+        selectSql.append(" where "+conditions.join(" and "));
+    }
+    //多查询一行，用于判断是否还有下一页
+    selectSql.append(QString(" order by %1 %2 limit %3;").arg(orderColumnName,isDescending ? "desc" : "asc").arg(pageSize+1));
+    QVariantList values;
+    int columnCount = 0;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+        if(!execSelect(selectSql,bindValues,values,&columnCount,-1,"select page error:"))
+        {
+            return false;
+        }
+    }
+    if(columnCount < 2)
+    {
+        return true;
+    }
+    int rowCount = qMin(values.size()/columnCount,pageSize);
+    rows.reserve(rowCount);
+    for(int row=0;row<rowCount;row++)
+    {
+        rows.append(values.mid(row*columnCount,columnCount-1));
+    }
+    if(values.size()/columnCount > pageSize)
+    {
+        nextKey = values.at(rowCount*columnCount-1);//本页最后一行的游标列
+    }
+    return true;
 }
 /*
  *@brief:   查询数据库表的行数
@@ -1076,8 +1582,7 @@ QVariantList DatabaseManager::selectSingleColDatas(QString tableName, QString co
  */
 int DatabaseManager::selectRowCount(QString tableName, QString whereSql)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
-    QString selectSql = QString("select count(0) from %1").arg(tableName);
+    QString selectSql = QString("select count(0) from %1").arg(stagingReadSource(tableName));
     if(whereSql.isEmpty())
     {
         selectSql.append(";");
@@ -1086,18 +1591,17 @@ int DatabaseManager::selectRowCount(QString tableName, QString whereSql)
     {
         selectSql.append(" where "+whereSql+";");
     }
+    QVariantList values;
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec(selectSql))
+    if(!execSelect(selectSql,QVariantList(),values,0,1,"select table row error:"))
     {
-        qDebug()<<"select table row error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return -1;
     }
-    if(query.next())
+    if(!values.isEmpty())
     {
-        return query.value(0).toInt();
+        return values.first().toInt();
     }
     else
     {
@@ -1113,22 +1617,19 @@ int DatabaseManager::selectRowCount(QString tableName, QString whereSql)
  */
 bool DatabaseManager::isExistTable(QString tableName)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
     QString selectSql = QString("select count(type) from sqlite_master where type='table' and "
                                 "name='%1';").arg(tableName);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    QVariantList values;
 #ifdef MT_SAFE
-    QReadLocker locker(&readWriteLock);//读锁
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
 #endif
-    if(!query.exec(selectSql))
+    if(!execSelect(selectSql,QVariantList(),values,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return false;
     }
-    if(query.next())//指向结果集的第一条记录
+    if(!values.isEmpty())//结果集的第一条记录
     {
-        return query.value(0).toBool();
+        return values.first().toBool();
     }
     else
     {
@@ -1136,6 +1637,167 @@ bool DatabaseManager::isExistTable(QString tableName)
         return false;
     }
 }
+/*
+ *@brief:   查询表的列名 使用pragma table_info语句，不依赖sqlite3.16才有的pragma_table_info()函数
+ *@date:    2026.10.19
+ *@param:   tableName: 表名
+ *@return:  QStringList:按建表顺序的列名 表不存在或失败时为空
+ */
+QStringList DatabaseManager::selectColumnNames(QString tableName)
+{
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+    return tableColumnNames(tableName);
+}
+/*
+ *@brief:   执行预先生成好的写操作sql 供编译期表结构(TableSchema,见tableschema.h)使用，
+ * sql在编译期生成，这里不再拼接，对tableName加写锁
+ * 注:1.sql中的表名固定为磁盘上的表，不能改写到暂存表，暂存的表(enableStaging())直接返回失败。
+ *    2.按列位置绑定的值不做压缩，配置了压缩列(setColumnCompression())的表同样返回失败。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   sql:带占位符的sql语句
+ *@param:   bindValues:按顺序绑定到占位符的值
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::execSchemaSql(const QString &tableName, const QString &sql, const QVariantList &bindValues)
+{
+    if(isStagedTable(tableName))
+    {
+        qDebug()<<"exec schema sql error: table is staged..."<<tableName;
+        return false;
+    }
+    if(hasColumnCompression(tableName))
+    {
+        qDebug()<<"exec schema sql error: table has compressed columns..."<<tableName;
+        return false;
+    }
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
+#else
+    Q_UNUSED(tableName);
+#endif
+    if(!execSql(sql,bindValues,"exec schema sql error:"))
+    {
+        return false;
+    }
+    refreshMirror(tableName);
+    return true;
+}
+/*
+ *@brief:   执行预先生成好的查询sql 供编译期表结构(TableSchema)使用，对tableName加读锁
+ * 注:1.与execSchemaSql()相同，暂存的表直接返回失败(查询磁盘上的表会漏掉暂存的行)，
+ *      配置了压缩列的表也返回失败。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   sql:带占位符的查询语句
+ *@param:   bindValues:按顺序绑定到占位符的值
+ *@param:   values:结果按行依次展开保存
+ *@param:   maxRows:最多读取的行数，-1表示全部
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::selectSchemaSql(const QString &tableName, const QString &sql, const QVariantList &bindValues,
+                                      QVariantList &values, int maxRows)
+{
+    if(isStagedTable(tableName))
+    {
+        qDebug()<<"select schema sql error: table is staged..."<<tableName;
+        return false;
+    }
+    if(hasColumnCompression(tableName))
+    {
+        qDebug()<<"select schema sql error: table has compressed columns..."<<tableName;
+        return false;
+    }
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#else
+    Q_UNUSED(tableName);
+#endif
+    return execSelect(sql,bindValues,values,0,maxRows,"select schema sql error:");
+}
+/*
+ *@brief:   打开指定行的BLOB字段，返回可以分块读写的设备
+ *  大数据(如数兆字节的波形数据)通过该设备按块读写，不需要一次性读入内存。例:
+ *    QIODevice *device = databaseManager->openBlob("wave","data",rowid,QIODevice::ReadOnly);
+ *    while(device && !device->atEnd()) { QByteArray chunk = device->read(64*1024); ... }
+ *    delete device;
+ *  写入时BLOB的长度不能改变，需要先调用resizeBlob()预留空间。
+ *  可写设备在关闭前一直占用连接的写事务，期间其他连接写入会忙等待，本管理器上其他线程的
+ *  事务提交可能失败(见sqliteblobdevice.h注4)，写完后应立即析构。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnName:BLOB字段名
+ *@param:   rowid:行的rowid(integer primary key字段即为rowid)
+ *@param:   mode:QIODevice::ReadOnly只读 QIODevice::WriteOnly/ReadWrite读写
+ *@return:  QIODevice*:已打开的设备，由调用者负责析构(须在关闭连接前析构)，失败返回0
+ */
+QIODevice *DatabaseManager::openBlob(QString tableName, QString columnName, qint64 rowid, QIODevice::OpenMode mode)
+{
+    sqlite3 *handle = sqliteHandle();
+    if(!handle)
+    {
+        qDebug()<<"open blob error: sqlite3 handle is not available";
+        return 0;
+    }
+#ifdef MT_SAFE
+    SqliteBlobDevice *device = new SqliteBlobDevice(handle,&lockManager,tableName,columnName,rowid);
+#else
+    SqliteBlobDevice *device = new SqliteBlobDevice(handle,0,tableName,columnName,rowid);
+#endif
+    bool isOpen;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+        isOpen = device->open(mode);
+    }
+    if(!isOpen)
+    {
+        delete device;
+        return 0;
+    }
+    return device;
+}
+/*
+ *@brief:   将指定行的BLOB字段重置为size字节的0(zeroblob)，为增量写入预留空间
+ *  zeroblob在数据库中只记录长度，不会在内存中构造size字节的数据
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnName:BLOB字段名
+ *@param:   rowid:行的rowid
+ *@param:   size:BLOB的字节数
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::resizeBlob(QString tableName, QString columnName, qint64 rowid, qint64 size)
+{
+    prepareStagedModify(tableName);//暂存表先刷新到磁盘再修改
+    QString updateSql = QString("update %1 set %2 = zeroblob(?) where rowid=?;").arg(tableName,columnName);
+    QVariantList bindValues;
+    bindValues<<size<<rowid;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
+#endif
+    if(!execSql(updateSql,bindValues,"resize blob error:"))
+    {
+        return false;
+    }
+    refreshMirror(tableName);
+    return true;
+}
+/*
+ *@brief:   查询各表的锁竞争统计信息 仅在MT_SAFE宏定义时有数据
+ *  可以据此判断哪些表的读写冲突严重，acquisitions为加锁次数，contentions为
+ *  加锁时需要等待的次数，waitMsecs为累计等待时间
+ *@date:    2026.10.19
+ *@param:   reset:获取后是否清空统计
+ *@return:  QHash<QString,TableLockStats>:小写表名->统计信息，数据库独占锁的键为DATABASE_LOCK_NAME
+ */
+QHash<QString,TableLockStats> DatabaseManager::lockStatistics(bool reset)
+{
+    return lockManager.statistics(reset);
+}
 /*
  *@brief:   附加数据库　实现在一个数据库里使用另一个数据库的数据
  *@author:  缪庆瑞
@@ -1147,16 +1809,10 @@ bool DatabaseManager::isExistTable(QString tableName)
 bool DatabaseManager::attachDB(QString attachDbName, QString aliasName)
 {
     QString attachSql = QString("attach database '%1' as '%2';").arg(attachDbName).arg(aliasName);
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(attachSql))
-    {
-        qDebug()<<"attach database error:"<<query.lastError();
-        return false;
-    }
-    return true;
+    return execSql(attachSql,QVariantList(),"attach database error:");
 }
 /*
  *@brief:   分离数据库　分离attach附加数据库的别名
@@ -1168,16 +1824,10 @@ bool DatabaseManager::attachDB(QString attachDbName, QString aliasName)
 bool DatabaseManager::detachDB(QString aliasName)
 {
     QString detachSql = QString("detach database '%1';").arg(aliasName);
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    DatabaseLocker locker(&lockManager);//数据库独占锁
 #endif
-    if(!query.exec(detachSql))
-    {
-        qDebug()<<"detach database error:"<<query.lastError();
-        return false;
-    }
-    return true;
+    return execSql(detachSql,QVariantList(),"detach database error:");
 }
 /*
  *@brief:   复制数据库表　仅执行insert的sql语句
@@ -1198,18 +1848,11 @@ bool DatabaseManager::onlyCopyTable(QString srcTableName, QString desTableName)
      */
     //QString copySql = QString("create table %1 as select * from %2;").arg(desTableName).arg(srcTableName);
     QString copySql = QString("insert into %1 select * from %2;").arg(desTableName).arg(srcTableName);
-    QSqlQuery query(db);//创建sql语句执行对象
 #ifdef MT_SAFE
-    QWriteLocker locker(&readWriteLock);//写锁
+    TableLocker locker(&lockManager,QStringList()<<srcTableName,QStringList()<<desTableName);//源表读锁 目的表写锁
 #endif
     //qDebug()<<"onlyCopyTable start time:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-    if(!query.exec(copySql))
-    {
-        qDebug()<<"copy table error:"<<query.lastError();
-        return false;
-    }
-    //qDebug()<<"onlyCopyTable end time:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
-    return true;
+    return execSql(copySql,QVariantList(),"copy table error:");
 }
 /*
  *@brief:   查询表是否存在 该方法主要用在内部的copyTable()函数内
@@ -1222,19 +1865,16 @@ bool DatabaseManager::onlyCopyTable(QString srcTableName, QString desTableName)
  */
 bool DatabaseManager::isExistTableForCopyTable(QString tableName)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
     QString selectSql = QString("select count(type) from sqlite_master where type='table' and "
                                 "name='%1';").arg(tableName);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
-    if(!query.exec(selectSql))
+    QVariantList values;
+    if(!execSelect(selectSql,QVariantList(),values,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return false;
     }
-    if(query.next())//指向结果集的第一条记录
+    if(!values.isEmpty())//结果集的第一条记录
     {
-        return query.value(0).toBool();
+        return values.first().toBool();
     }
     else
     {
@@ -1242,6 +1882,18 @@ bool DatabaseManager::isExistTableForCopyTable(QString tableName)
         return false;
     }
 }
+/*
+ *@brief:   建表 该方法主要用在内部的copyTable()函数内
+ * 无论MT_SAFE宏是否定义，该方法都不会加锁，避免copyTable()在持有表锁时
+ * 再升级为数据库独占锁造成死锁
+ *@date:    2026.10.19
+ *@param:   createSql:完整的建表语句
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::createTableForCopyTable(QString createSql)
+{
+    return execSql(createSql,QVariantList(),"create table error:");
+}
 /*
  *@brief:   获取表的创建语句 该方法主要用在内部的copyTable()函数内
  * 无论MT_SAFE宏是否定义，该方法都不会加读锁，避免同一个线程在copyTable()
@@ -1254,18 +1906,15 @@ bool DatabaseManager::isExistTableForCopyTable(QString tableName)
  */
 QString DatabaseManager::getCreateTableSqlForCopyTable(QString masterTableName, QString tableName)
 {
-    QSqlQuery query(db);//创建sql语句执行对象
     QString selectSql = QString("select sql from %1 where type='table' and name='%2';").arg(masterTableName,tableName);
-    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
-    if(!query.exec(selectSql))
+    QVariantList values;
+    if(!execSelect(selectSql,QVariantList(),values,0,1,"select table error:"))
     {
-        qDebug()<<"select table error:"<<query.lastError();
-        qDebug()<<"error sql:"<<selectSql;
         return QString();//返回无效的数据
     }
-    if(query.next())//指向结果集的第一条记录
+    if(!values.isEmpty())//结果集的第一条记录
     {
-        return query.value(0).toString();
+        return values.first().toString();
     }
     else
     {
@@ -1273,3 +1922,2415 @@ QString DatabaseManager::getCreateTableSqlForCopyTable(QString masterTableName,
         return QString();//返回无效的数据
     }
 }
+/*
+ *@brief:   快速启动的后台任务 在工作线程中新建一个连接执行完整性检测和预读，
+ * 完成后写入启动耗时统计。连接在本线程中创建和关闭(Qt的数据库连接只能在创建它的线程中使用)
+ *@date:    2026.10.19
+ *@param:   databaseName:数据库名
+ *@param:   isIntegrityCheck:是否执行完整性检测
+ *@param:   prefetchTables:预读的表
+ */
+void DatabaseManager::runStartupTasks(const QString &databaseName, bool isIntegrityCheck, const QStringList &prefetchTables)
+{
+    DatabaseManager worker(connectionName+"_startup");
+    worker.shareCodecDictionaries(this);
+    if(!worker.createSqliteConnection(databaseName))
+    {
+        return;
+    }
+    QElapsedTimer timer;
+    if(isIntegrityCheck)
+    {
+        timer.start();
+        bool isIntegrity = worker.integrityCheck();
+        {
+            QMutexLocker locker(&startupMutex);
+            startupTimings.integrityCheckUsecs = timer.nsecsElapsed()/1000;
+            startupTimings.isIntegrity = isIntegrity;
+        }
+        emit integrityChecked(isIntegrity);
+    }
+    if(!prefetchTables.isEmpty())
+    {
+        timer.start();
+        for(int i=0;i<prefetchTables.size();i++)
+        {
+            worker.prefetchTable(prefetchTables.at(i));
+        }
+        QMutexLocker locker(&startupMutex);
+        startupTimings.prefetchUsecs = timer.nsecsElapsed()/1000;
+    }
+}
+/*
+ *@brief:   顺序读取表及其索引的所有数据页 数据页进入系统的文件缓存(开启mmap时即映射的内存)，
+ * 之后主连接读取这些页时不需要等待磁盘。只调用next()不取值，不产生QVariant。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::prefetchTable(const QString &tableName)
+{
+    QSqlQuery query(db);//创建sql语句执行对象
+    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    if(!query.exec(QString("select * from %1;").arg(tableName)))
+    {
+        qDebug()<<"prefetch table error:"<<query.lastError();
+        return false;
+    }
+    while(query.next())
+    {
+    }
+    //只查询索引中的列时sqlite直接扫描索引(覆盖索引)，indexed by保证使用指定的索引
+    //使用pragma语句而不是pragma_index_list()等表值函数(sqlite3.16及以上才支持)
+    QVariantList indexList;
+    int listColumnCount = 0;
+    //index_list每行为(seq,name,unique[,origin,partial])
+    if(!execSelect(QString("pragma index_list(%1);").arg(tableName),QVariantList(),indexList,&listColumnCount,-1,
+                   "prefetch table error:"))
+    {
+        return false;
+    }
+    for(int i=1;listColumnCount>1 && i<indexList.size();i+=listColumnCount)
+    {
+        QString indexName = indexList.at(i).toString();
+        QVariantList indexInfo;
+        int infoColumnCount = 0;
+        //index_info每行为(seqno,cid,name) 表达式列的name为NULL
+        execSelect(QString("pragma index_info(%1);").arg(indexName),QVariantList(),indexInfo,&infoColumnCount,-1,
+                   "prefetch index error:");
+        QStringList columnNames;
+        bool isExpression = false;
+        for(int j=2;infoColumnCount>2 && j<indexInfo.size();j+=infoColumnCount)
+        {
+            if(indexInfo.at(j).isNull())
+            {
+                isExpression = true;
+                break;
+            }
+            columnNames<<indexInfo.at(j).toString();
+        }
+        if(columnNames.isEmpty() || isExpression)
+        {
+            continue;//表达式索引
+        }
+        if(!query.exec(QString("select %1 from %2 indexed by %3;").arg(columnNames.join(","),tableName,indexName)))
+        {
+            qDebug()<<"prefetch index error:"<<query.lastError();
+            continue;
+        }
+        while(query.next())
+        {
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   获取底层的sqlite3连接句柄 用于调用Qt未封装的sqlite3 C接口
+ * 只有定义了SQLITE_NATIVE_API，且QSQLITE驱动与程序链接的是同一个sqlite3库时才可用。
+ * 驱动插件未使用-system-sqlite编译时自带一份sqlite3，它的句柄交给程序链接的sqlite3库
+ * 使用是未定义行为(通常直接崩溃)。所以每个连接第一次获取句柄时，比较驱动执行
+ * "select sqlite_source_id()"的结果与本程序链接的库的sqlite3_sourceid()，不一致时返回0，
+ * 所有原生接口按不可用处理(语句改用QSqlQuery执行，BLOB流式读写等返回失败)。
+ *@date:    2026.10.19
+ *@return:  sqlite3*:连接句柄，不可用时返回0
+ */
+sqlite3 *DatabaseManager::sqliteHandle()
+{
+#ifdef SQLITE_NATIVE_API
+    if(!db.isOpen() || nativeHandleState == 0)
+    {
+        return 0;
+    }
+    QVariant handle = db.driver()->handle();
+    if(!handle.isValid() || qstrcmp(handle.typeName(),"sqlite3*") != 0)
+    {
+        return 0;
+    }
+    if(nativeHandleState < 0)
+    {
+        QSqlQuery query(db);//创建sql语句执行对象
+        QString driverSourceId;
+        if(query.exec("select sqlite_source_id();") && query.next())
+        {
+            driverSourceId = query.value(0).toString();
+        }
+        query.finish();
+        nativeHandleState = (driverSourceId == QString::fromLatin1(sqlite3_sourceid())) ? 1 : 0;
+        if(!nativeHandleState)
+        {
+            qDebug()<<"sqlite native api disabled: QSQLITE plugin uses a different sqlite3 library"
+                   <<driverSourceId<<sqlite3_sourceid();
+            return 0;
+        }
+    }
+    return *static_cast<sqlite3 **>(handle.data());
+#else
+    return 0;
+#endif
+}
+/*
+ *@brief:   开启内存暂存 慢速存储(eMMC等)上高频写入的表，写入先进入附加的内存数据库
+ * (staging)中的同名表，定时器按flushIntervalMsecs或暂存行数达到flushRowCount时，在一个
+ * 事务内批量写入磁盘上的表。查询这些表时合并暂存和磁盘上的数据；修改/删除这些表之前
+ * 会先刷新，保证修改作用于全部数据。
+ * 注:1.崩溃或断电时，最多丢失flushIntervalMsecs时间内、不超过flushRowCount行的数据，
+ *      可以通过stagingStats()查看当前暂存(有丢失风险)的数据量。
+ *    2.暂存表保留原表列的类型、默认值和非空约束，但没有主键、唯一等约束，这些约束在刷新
+ *      到磁盘时才会检查，违反约束时刷新失败，数据保留在暂存表中。
+ *    3.定时器运行在调用该方法的线程中(需要事件循环)，应在创建DatabaseManager的线程调用；
+ *      定时器只触发刷新，刷新本身在线程池中执行，不会阻塞该线程。
+ *    4.暂存期间不要对这些表进行复制表、BLOB流式读写等操作；读快照(ReadSnapshot)使用
+ *      独立的连接，看不到暂存的数据。
+ *    5.查询暂存表时数据源是磁盘表与暂存表的合并子查询，查询的列和条件中不能使用rowid
+ *      (暂存的行在刷新前也没有最终的rowid)；省略的integer primary key列在刷新前为NULL。
+ *      需要按行标识查询时请使用显式声明的主键列。
+ *@date:    2026.10.19
+ *@param:   tableNames:需要暂存的表(必须已存在)
+ *@param:   options:刷新间隔及行数阈值
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::enableStaging(QList<QString> tableNames, StagingOptions options)
+{
+    {
+#ifdef MT_SAFE
+        DatabaseLocker locker(&lockManager);//数据库独占锁
+#endif
+        if(!stagedTableCount.load() && !attachDB(":memory:","staging"))
+        {
+            return false;
+        }
+        for(int i=0;i<tableNames.size();i++)
+        {
+            if(isStagedTable(tableNames.at(i)))
+            {
+                continue;
+            }
+            QString createSql = stagingCreateSql(tableNames.at(i));
+            if(createSql.isEmpty() || !execSql(createSql,QVariantList(),"create staging table error:"))
+            {
+                if(!stagedTableCount.load())
+                {
+                    detachDB("staging");
+                }
+                return false;
+            }
+            QMutexLocker stagingLocker(&stagingMutex);
+            stagedTables.append(tableNames.at(i));
+            stagedTableCount.storeRelease(stagedTables.size());
+        }
+    }
+    {
+        QMutexLocker locker(&stagingMutex);
+        stagingOptions = options;
+        lastFlushTime.start();
+    }
+    if(!stagingTimer)
+    {
+        stagingTimer = new QTimer(this);
+        /*定时器只负责触发，刷新(加写锁、批量写磁盘)在线程池中执行，不占用调用线程(通常是界面线程)。
+         *上一次刷新还没结束时跳过本次*/
+        connect(stagingTimer,&QTimer::timeout,this,[this](){
+            if(stagingFlushFuture.isRunning())
+            {
+                return;
+            }
+            stagingFlushFuture = QtConcurrent::run([this](){ flushStaging(); });
+        });
+    }
+    stagingTimer->start(qMax(options.flushIntervalMsecs,1));
+    return true;
+}
+/*
+ *@brief:   关闭内存暂存 剩余数据刷新到磁盘后分离内存数据库
+ *@date:    2026.10.19
+ *@return:  返回值为布尔类型，true:成功，false:刷新失败(暂存的数据仍然保留)
+ */
+bool DatabaseManager::disableStaging()
+{
+    if(!stagedTableCount.load())
+    {
+        return true;
+    }
+    if(stagingTimer)
+    {
+        stagingTimer->stop();
+    }
+    stagingFlushFuture.waitForFinished();//等待后台的刷新结束
+    if(!flushStaging())
+    {
+        if(stagingTimer)
+        {
+            stagingTimer->start();//暂存仍然开启，继续定时刷新
+        }
+        return false;
+    }
+#ifdef MT_SAFE
+    DatabaseLocker locker(&lockManager);//数据库独占锁
+#endif
+    if(!stagedTableCount.load())
+    {
+        return true;//最后一个暂存表已被删除，内存数据库已分离
+    }
+    {
+        QMutexLocker stagingLocker(&stagingMutex);
+        stagedTables.clear();
+        stagedTableCount.storeRelease(0);
+    }
+    return detachDB("staging");
+}
+/*
+ *@brief:   把暂存的数据在一个事务内写入磁盘上的表，并清空暂存表
+ *@date:    2026.10.19
+ *@return:  返回值为布尔类型，true:成功，false:失败(暂存的数据仍然保留，下次刷新时重试)
+ */
+bool DatabaseManager::flushStaging()
+{
+    if(!stagedTableCount.load())
+    {
+        return true;
+    }
+    QStringList stagedTables;//副本 表名列表可能同时被enableStaging()修改
+    {
+        QMutexLocker stagingLocker(&stagingMutex);
+        stagedTables = this->stagedTables;
+    }
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),stagedTables);//所有暂存表加写锁
+#endif
+    {
+        //加锁期间表可能已被删除并移出列表(dropTable())，只刷新仍在列表中的表
+        QMutexLocker stagingLocker(&stagingMutex);
+        for(int i=stagedTables.size()-1;i>=0;i--)
+        {
+            if(!this->stagedTables.contains(stagedTables.at(i),Qt::CaseInsensitive))
+            {
+                stagedTables.removeAt(i);
+            }
+        }
+    }
+    if(!beginTransaction("flush staging transaction error:"))
+    {
+        return false;
+    }
+    int rowCount = stagedRowCount.fetchAndStoreOrdered(0);
+    bool isSuccess = true;
+    for(int i=0;isSuccess && i<stagedTables.size();i++)
+    {
+        const QString &tableName = stagedTables.at(i);
+        //按列名写入 不依赖两个表的列顺序
+        QString columns = tableColumnNames(tableName,"staging").join(",");
+        isSuccess = !columns.isEmpty() &&
+                execSql(QString("insert into main.%1(%2) select %2 from staging.%1;").arg(tableName,columns),
+                        QVariantList(),"flush staging table error:") &&
+                execSql(QString("delete from staging.%1;").arg(tableName),QVariantList(),"flush staging table error:");
+    }
+    if(isSuccess)
+    {
+        isSuccess = commitTransaction("flush staging transaction error:");
+    }
+    else
+    {
+        rollbackTransaction();
+    }
+    if(!isSuccess)
+    {
+        stagedRowCount.fetchAndAddOrdered(rowCount);//数据仍在暂存表中
+        return false;
+    }
+    QMutexLocker statsLocker(&stagingMutex);
+    lastFlushTime.restart();
+    stagingFlushCount++;
+    stagingFlushedRows += rowCount;
+    return true;
+}
+/*
+ *@brief:   获取内存暂存的统计信息
+ *@date:    2026.10.19
+ *@return:  StagingStats:暂存统计 未开启暂存时isEnabled为false
+ */
+StagingStats DatabaseManager::stagingStats()
+{
+    StagingStats stats;
+    QMutexLocker locker(&stagingMutex);
+    stats.isEnabled = !stagedTables.isEmpty();
+    stats.stagedRows = stagedRowCount.load();
+    stats.maxLossMsecs = stagingOptions.flushIntervalMsecs;
+    stats.maxLossRows = stagingOptions.flushRowCount;
+    stats.msecsSinceFlush = lastFlushTime.isValid() ? lastFlushTime.elapsed() : 0;
+    stats.flushCount = stagingFlushCount;
+    stats.flushedRows = stagingFlushedRows;
+    return stats;
+}
+/*
+ *@brief:   将读多写少的表加载到内存镜像 之后按键值列的单行查询(selectSingleColData()/
+ * selectMultiColData()的whereColName为键值列)直接从内存返回，不执行sql也不加表锁。
+ * 通过DatabaseManager对该表的每次写操作都会在写入磁盘后同步更新镜像。
+ * 注:1.键值列必须唯一(主键或唯一约束)，只有查询的列都是表中的普通列时才走镜像。
+ *    2.绕过DatabaseManager的修改(其他连接或进程、openBlob()写入)不会反映到镜像中，
+ *      可以再次调用pinTable()重新加载。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   keyColumnName:键值列名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::pinTable(QString tableName, QString keyColumnName)
+{
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁 加载期间不会有写操作
+#endif
+    QSharedPointer<TableMirror> mirror(new TableMirror(tableColumnNames(tableName),keyColumnName));
+    if(!mirror->isValid())
+    {
+        qDebug()<<"pin table error: table or key column doesn't exist..."<<tableName<<keyColumnName;
+        return false;
+    }
+    if(!loadMirror(mirror.data(),tableName))
+    {
+        return false;
+    }
+    QWriteLocker mirrorLocker(&mirrorLock);
+    if(!mirrors.contains(tableName.toLower()))
+    {
+        mirrorCount.ref();
+    }
+    mirrors.insert(tableName.toLower(),mirror);
+    return true;
+}
+/*
+ *@brief:   释放表的内存镜像 之后的查询恢复为执行sql
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ */
+void DatabaseManager::unpinTable(QString tableName)
+{
+    if(!mirrorCount.load())
+    {
+        return;
+    }
+    QWriteLocker mirrorLocker(&mirrorLock);
+    if(mirrors.remove(tableName.toLower()))
+    {
+        mirrorCount.deref();
+    }
+}
+
+bool DatabaseManager::isPinnedTable(QString tableName)
+{
+    return !findMirror(tableName).isNull();
+}
+/*
+ *@brief:   为表的某一列开启透明压缩 之后通过insertTable()/insertBatchTable()/insertRecords()/
+ * updateTable()写入该列的大字段会被压缩，所有查询接口返回解压后的值。
+ * 注:1.insertTable(insertSql)/updateTable(updateSql)等完整sql语句不做压缩，编译期表结构
+ *      (execSchemaSql()/selectSchemaSql())不支持配置了压缩列的表。
+ *    2.开启前已存在的值不受影响，压缩值和原始值可以混合存储在同一列中。
+ *    3.查询时只有配置过压缩列才会检查压缩值，已有压缩数据的数据库需要在连接后先配置。
+ *      关闭压缩(removeColumnCompression())后已压缩的值仍可正常查询。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnName:列名 一般为TEXT/BLOB类型的大字段
+ *@param:   options:压缩选项(阈值、压缩级别、预置字典)
+ *@return:  返回值为布尔类型，true:成功，false:表或列不存在
+ */
+bool DatabaseManager::setColumnCompression(QString tableName, QString columnName, ColumnCompressionOptions options)
+{
+    QStringList columnNames;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,tableName,TableLocker::ReadLock);//读锁
+#endif
+        columnNames = tableColumnNames(tableName);
+    }
+    if(!columnNames.contains(columnName.trimmed(),Qt::CaseInsensitive))
+    {
+        qDebug()<<"set column compression error: table or column doesn't exist..."<<tableName<<columnName;
+        return false;
+    }
+    QSharedPointer<ColumnCodec> codec(new ColumnCodec(options));
+    QWriteLocker codecLocker(&codecLock);
+    TableCodecs &tableCodecs = columnCodecs[tableName.toLower()];
+    tableCodecs.columnNames = columnNames;
+    if(!tableCodecs.codecs.contains(columnName.trimmed().toLower()))
+    {
+        codecCount.ref();
+    }
+    tableCodecs.codecs.insert(columnName.trimmed().toLower(),codec);
+    isDecompressEnabled.storeRelease(1);
+    if(codec->dictionaryId())
+    {
+        codecDictionaries.insert(codec->dictionaryId(),options.dictionary);
+    }
+    return true;
+}
+/*
+ *@brief:   关闭列的压缩 之后写入的值原样存储，已压缩的值查询时仍会解压
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnName:列名
+ */
+void DatabaseManager::removeColumnCompression(QString tableName, QString columnName)
+{
+    if(!codecCount.load())
+    {
+        return;
+    }
+    QWriteLocker codecLocker(&codecLock);
+    QHash<QString,TableCodecs>::iterator iter = columnCodecs.find(tableName.toLower());
+    if(iter == columnCodecs.end() || !iter->codecs.remove(columnName.trimmed().toLower()))
+    {
+        return;
+    }
+    if(iter->codecs.isEmpty())
+    {
+        columnCodecs.erase(iter);
+    }
+    codecCount.deref();//预置字典不删除，表中已压缩的值仍需要它解压
+}
+/*
+ *@brief:   获取各压缩列的统计信息 按写入的数据计算
+ *@date:    2026.10.19
+ *@return:  QHash:"小写表名.小写列名"->统计信息
+ */
+QHash<QString,ColumnCompressionStats> DatabaseManager::columnCompressionStats()
+{
+    QHash<QString,ColumnCompressionStats> stats;
+    QReadLocker codecLocker(&codecLock);
+    QHash<QString,TableCodecs>::const_iterator tableIter = columnCodecs.constBegin();
+    for(;tableIter != columnCodecs.constEnd();++tableIter)
+    {
+        QHash<QString,QSharedPointer<ColumnCodec> >::const_iterator iter = tableIter->codecs.constBegin();
+        for(;iter != tableIter->codecs.constEnd();++iter)
+        {
+            stats.insert(tableIter.key()+"."+iter.key(),iter.value()->stats());
+        }
+    }
+    return stats;
+}
+/*
+ *@brief:   增量复制表 数据库内复制
+ * 大多数复制的源表自上次复制后只是新增了数据，copyTable()每次清空目的表重新复制所有行。
+ * 增量复制在目的数据库的水位表(copy_watermark)中按(源表,目的表)记录上次复制时水位列的
+ * 最大值，之后只执行"insert or replace into 目的表 select * from 源表 where 水位列 >= 上次水位"
+ * (rowid为>)。
+ * 没有水位记录、水位列改变、目的表不存在或源表的建表语句变化时执行全量复制。
+ * 注:1.水位列的值必须随新增/修改单调不减:rowid(只追加的表，删除最大rowid的行后rowid可能被
+ *      重用，需要AUTOINCREMENT)或修改时间列(修改的行也会被复制，目的表需要主键才能覆盖旧行)。
+ *      时间列的值等于上次水位的行每次都会重新复制，以免漏掉之后才提交的同一时间的行。
+ *    2.源表中删除的行不会同步到目的表，需要同步删除时使用变更集(startChangeCapture())。
+ *@date:    2026.10.19
+ *@param:   srcTableName:源表名
+ *@param:   desTableName:目的表名
+ *@param:   watermarkColumnName:水位列 默认为rowid
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::copyTableDelta(QString srcTableName, QString desTableName, QString watermarkColumnName)
+{
+    //暂存表先刷新到磁盘，加锁之后不能再刷新(需要对暂存表加写锁)
+    prepareStagedModify(srcTableName);
+    prepareStagedModify(desTableName);
+#ifdef MT_SAFE
+    //源表读锁 目的表和水位表写锁 原因同copyTable()
+    TableLocker locker(&lockManager,QStringList()<<srcTableName,QStringList()<<desTableName<<COPY_WATERMARK_TABLE);
+#endif
+    return deltaCopyTable(srcTableName,"main",srcTableName,desTableName,watermarkColumnName);
+}
+/*
+ *@brief:   增量复制表 数据库间复制 水位按源数据库名和源表名记录
+ *@date:    2026.10.19
+ *@param:   srcDbName:源数据库名
+ *@param:   srcTableName:源表名
+ *@param:   desTableName:目的表名
+ *@param:   watermarkColumnName:水位列 默认为rowid
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::copyTableDelta(QString srcDbName, QString srcTableName, QString desTableName, QString watermarkColumnName)
+{
+    prepareStagedModify(desTableName);
+#ifdef MT_SAFE
+    DatabaseLocker locker(&lockManager);//数据库独占锁　原因同copyTable()
+#endif
+    QString aliasName = "sourceDB";//附加数据库别名
+    if(!attachDB(srcDbName,aliasName))
+    {
+        return false;
+    }
+    bool isSuccess = deltaCopyTable(srcDbName+":"+srcTableName,aliasName,srcTableName,desTableName,watermarkColumnName);
+    //分离数据库表
+    return detachDB(aliasName) && isSuccess;
+}
+/*
+ *@brief:   增量复制的实现 调用者负责加锁及附加源数据库
+ *@date:    2026.10.19
+ *@param:   sourceName:水位表中源表的标识
+ *@param:   schemaName:源表所在的数据库(main或附加数据库的别名)
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::deltaCopyTable(const QString &sourceName, const QString &schemaName, const QString &srcTableName,
+                                     const QString &desTableName, const QString &watermarkColumnName)
+{
+    QString createWatermarkSql = QString("create table if not exists %1(source text,destination text,watermark_column text,"
+                                         "watermark,schema_sql text,primary key(source,destination));").arg(COPY_WATERMARK_TABLE);
+    if(!execSql(createWatermarkSql,QVariantList(),"create table error:"))
+    {
+        return false;
+    }
+    QString srcSchemaSql = getCreateTableSqlForCopyTable(schemaName+".sqlite_master",srcTableName);
+    if(srcSchemaSql.isEmpty())
+    {
+        qDebug()<<"copy table error: source table doesn't exist..."<<schemaName<<srcTableName;
+        return false;
+    }
+    QString srcName = QString("%1.%2").arg(schemaName,srcTableName);
+    //本次复制的水位 复制前读取，复制期间新增的行留到下一次复制(insert or replace避免重复)
+    QVariantList values;
+    if(!execSelect(QString("select max(%1) from %2;").arg(watermarkColumnName,srcName),QVariantList(),values,0,1,
+                   "copy table error:"))
+    {
+        return false;
+    }
+    QVariant newWatermark = values.value(0);
+    values.clear();
+    if(!execSelect(QString("select watermark_column,watermark,schema_sql from %1 where source=? and destination=?;")
+                   .arg(COPY_WATERMARK_TABLE),QVariantList()<<sourceName<<desTableName,values,0,1,"copy table error:"))
+    {
+        return false;
+    }
+    bool hasWatermark = values.size() == 3;
+    bool isSchemaChanged = hasWatermark && values.at(2).toString() != srcSchemaSql;
+    bool isSameColumn = hasWatermark && values.at(0).toString() == watermarkColumnName;
+    bool isDesExist = isExistTableForCopyTable(desTableName);
+    if(isSameColumn && !isSchemaChanged && isDesExist)
+    {
+        //增量复制 只复制水位之后的行
+        QVariant oldWatermark = values.at(1);
+        if(!newWatermark.isNull())
+        {
+            QString copySql = QString("insert or replace into %1 select * from %2 where %3 <= ?").arg(desTableName,srcName,watermarkColumnName);
+            QVariantList bindValues;
+            bindValues<<newWatermark;
+            if(!oldWatermark.isNull())
+            {
+                /*rowid每行唯一，从上次水位之后开始即可；时间列可能有多行相同的值，上次复制后才
+                 *提交的行可能与水位相等，所以从水位本身开始重新复制(insert or replace不会重复)*/
+                bool isRowid = watermarkColumnName.compare("rowid",Qt::CaseInsensitive) == 0;
+                copySql.append(QString(isRowid ? " and %1 > ?" : " and %1 >= ?").arg(watermarkColumnName));
+                bindValues<<oldWatermark;
+            }
+            if(!execSql(copySql+";",bindValues,"copy table error:"))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        //全量复制 源表结构变化时目的表需要按新的结构重建
+        if(isDesExist && isSchemaChanged)
+        {
+            if(!execSql(QString("drop table %1;").arg(desTableName),QVariantList(),"drop table error:"))
+            {
+                return false;
+            }
+            unpinTable(desTableName);
+            isDesExist = false;
+        }
+        if(isDesExist)
+        {
+            if(!execSql(QString("delete from %1;").arg(desTableName),QVariantList(),"delete table error:"))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            QString createTableSql = srcSchemaSql;
+            createTableSql.replace(srcTableName,desTableName);//替换成新表名
+            if(!createTableForCopyTable(createTableSql))
+            {
+                return false;
+            }
+        }
+        notifyTableCleared(desTableName);
+        if(!onlyCopyTable(srcName,desTableName))
+        {
+            return false;
+        }
+    }
+    //更新水位 源表为空时保留原来的水位
+    if(newWatermark.isNull() && isSameColumn && !isSchemaChanged)
+    {
+        newWatermark = values.at(1);
+    }
+    QString watermarkSql = QString("insert or replace into %1 values(?,?,?,?,?);").arg(COPY_WATERMARK_TABLE);
+    if(!execSql(watermarkSql,QVariantList()<<sourceName<<desTableName<<watermarkColumnName<<newWatermark<<srcSchemaSql,
+                "copy table error:"))
+    {
+        return false;
+    }
+    refreshMirror(desTableName);
+    return true;
+}
+/*
+ *@brief:   开始记录表的变更 建立变更日志表(表名_changelog)和插入/修改/删除触发器，
+ * 日志只记录变更的操作和键值，行数据在导出变更集时读取。日志表的第三列以键值列命名，
+ * 重启后导出变更集时据此得到键值列。已经开始记录时直接返回成功。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   keyColumnName:键值列 必须唯一(主键或唯一约束)
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::startChangeCapture(QString tableName, QString keyColumnName)
+{
+    QString logTableName = tableName+CHANGELOG_SUFFIX;
+    QStringList sqls;
+    sqls<<QString("create table if not exists %1(seq integer primary key autoincrement,operation integer,%2);")
+          .arg(logTableName,keyColumnName);
+    sqls<<QString("create trigger if not exists %1_ai after insert on %2 begin "
+                  "insert into %1(operation,%3) values(%4,new.%3); end;")
+          .arg(logTableName,tableName,keyColumnName).arg(int(ChangesetEntry::Insert));
+    //修改键值相当于删除旧键值的行并插入新键值的行
+    sqls<<QString("create trigger if not exists %1_au after update on %2 begin "
+                  "insert into %1(operation,%3) select %4,old.%3 where old.%3 is not new.%3; "
+                  "insert into %1(operation,%3) select case when old.%3 is new.%3 then %5 else %6 end,new.%3; end;")
+          .arg(logTableName,tableName,keyColumnName).arg(int(ChangesetEntry::Delete)).arg(int(ChangesetEntry::Update))
+          .arg(int(ChangesetEntry::Insert));
+    sqls<<QString("create trigger if not exists %1_ad after delete on %2 begin "
+                  "insert into %1(operation,%3) values(%4,old.%3); end;")
+          .arg(logTableName,tableName,keyColumnName).arg(int(ChangesetEntry::Delete));
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<logTableName);//写锁
+#endif
+    if(!tableColumnNames(tableName).contains(keyColumnName,Qt::CaseInsensitive))
+    {
+        qDebug()<<"start change capture error: table or key column doesn't exist..."<<tableName<<keyColumnName;
+        return false;
+    }
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"start change capture error:"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   停止记录表的变更 删除触发器和变更日志表，未导出的变更将丢失
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::stopChangeCapture(QString tableName)
+{
+    QString logTableName = tableName+CHANGELOG_SUFFIX;
+    QStringList sqls;
+    sqls<<QString("drop trigger if exists %1_ai;").arg(logTableName)
+        <<QString("drop trigger if exists %1_au;").arg(logTableName)
+        <<QString("drop trigger if exists %1_ad;").arg(logTableName)
+        <<QString("drop table if exists %1;").arg(logTableName);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<logTableName);//写锁
+#endif
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"stop change capture error:"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   导出变更集 合并变更日志(同一键值的多次变更只保留最终结果)，读取插入/修改的行的
+ * 最新数据写入文件，成功后删除已导出的日志。没有变更时同样生成(空的)变更集文件。
+ *@date:    2026.10.19
+ *@param:   tableName:表名 需要已调用startChangeCapture()
+ *@param:   fileName:变更集文件名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::writeChangeset(QString tableName, QString fileName)
+{
+    prepareStagedModify(tableName);//暂存的数据刷新到磁盘后才会触发日志记录
+    QString logTableName = tableName+CHANGELOG_SUFFIX;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList()<<tableName,QStringList()<<logTableName);//表读锁 日志表写锁
+#endif
+    QStringList logColumnNames = tableColumnNames(logTableName);
+    if(logColumnNames.size() != 3)
+    {
+        qDebug()<<"write changeset error: change capture isn't started..."<<tableName;
+        return false;
+    }
+    Changeset changeset;
+    changeset.tableName = tableName;
+    changeset.keyColumnName = logColumnNames.at(2);
+    changeset.columnNames = tableColumnNames(tableName);
+    QVariantList logValues;
+    if(!execSelect(QString("select seq,operation,%1 from %2 order by seq;").arg(changeset.keyColumnName,logTableName),
+                   QVariantList(),logValues,0,-1,"write changeset error:"))
+    {
+        return false;
+    }
+    //按键值合并 记录每个键值第一次和最后一次的操作，保持键值第一次出现的顺序
+    QList<QVariant> keyValues;
+    QHash<QString,QPair<int,int> > keyOperations;
+    qint64 lastSeq = -1;
+    for(int i=0;i+2<logValues.size();i+=3)
+    {
+        lastSeq = logValues.at(i).toLongLong();
+        int operation = logValues.at(i+1).toInt();
+        QString key = logValues.at(i+2).toString();
+        QHash<QString,QPair<int,int> >::iterator it = keyOperations.find(key);
+        if(it == keyOperations.end())
+        {
+            keyOperations.insert(key,qMakePair(operation,operation));
+            keyValues.append(logValues.at(i+2));
+        }
+        else
+        {
+            it.value().second = operation;
+        }
+    }
+    QString selectSql = QString("select %1 from %2 where %3=?;")
+            .arg(changeset.columnNames.join(","),tableName,changeset.keyColumnName);
+    for(int i=0;i<keyValues.size();i++)
+    {
+        QPair<int,int> operations = keyOperations.value(keyValues.at(i).toString());
+        ChangesetEntry entry;
+        entry.keyValue = keyValues.at(i);
+        if(operations.second == ChangesetEntry::Delete)
+        {
+            if(operations.first == ChangesetEntry::Insert)
+            {
+                continue;//插入后又删除，对其他数据库没有影响
+            }
+            entry.operation = ChangesetEntry::Delete;
+        }
+        else
+        {
+            //先插入的仍是插入，其他(修改、删除后重新插入)对目的库而言都是修改已有的行
+            entry.operation = (operations.first == ChangesetEntry::Insert) ? ChangesetEntry::Insert : ChangesetEntry::Update;
+            if(!execSelect(selectSql,QVariantList()<<entry.keyValue,entry.rowValues,0,1,"write changeset error:"))
+            {
+                return false;
+            }
+            if(entry.rowValues.isEmpty())
+            {
+                continue;//日志与表不一致(例如关闭过触发器)，以表为准
+            }
+        }
+        changeset.entries.append(entry);
+    }
+    if(!changeset.save(fileName))
+    {
+        return false;
+    }
+    //只删除已导出的日志
+    return lastSeq < 0 || execSql(QString("delete from %1 where seq <= ?;").arg(logTableName),QVariantList()<<lastSeq,
+                                  "write changeset error:");
+}
+/*
+ *@brief:   应用变更集 所有变更在一个事务内执行，冲突按policy处理，Abort时回滚整个变更集
+ *@date:    2026.10.19
+ *@param:   fileName:变更集文件名
+ *@param:   policy:冲突处理策略
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::applyChangeset(QString fileName, Changeset::ConflictPolicy policy)
+{
+    Changeset changeset;
+    if(!changeset.load(fileName))
+    {
+        return false;
+    }
+    prepareStagedModify(changeset.tableName);//暂存表先刷新到磁盘再修改
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,changeset.tableName,TableLocker::WriteLock);//写锁
+#endif
+    QStringList columnNames = tableColumnNames(changeset.tableName);
+    for(int i=0;i<changeset.columnNames.size();i++)
+    {
+        if(!columnNames.contains(changeset.columnNames.at(i),Qt::CaseInsensitive))
+        {
+            qDebug()<<"apply changeset error: table schema doesn't match..."<<changeset.tableName<<changeset.columnNames.at(i);
+            return false;
+        }
+    }
+    if(!beginTransaction("apply changeset transaction error:"))
+    {
+        return false;
+    }
+    int conflictCount = 0;
+    for(int i=0;i<changeset.entries.size();i++)
+    {
+        bool isConflict = false;
+        bool isSuccess = applyChangesetEntry(changeset,changeset.entries.at(i),policy,isConflict);
+        if(isConflict)
+        {
+            conflictCount++;
+        }
+        if(!isSuccess)
+        {
+            rollbackTransaction();//应用失败，回滚到之前的状态
+            return false;
+        }
+    }
+    if(!commitTransaction("apply changeset transaction error:"))
+    {
+        return false;
+    }
+    if(conflictCount)
+    {
+        qDebug()<<"apply changeset conflicts:"<<conflictCount<<"policy:"<<policy;
+    }
+    refreshMirror(changeset.tableName);
+    return true;
+}
+/*
+ *@brief:   为表的文本列建立全文索引 索引表(表名_fts)为FTS5外部内容表，只保存索引不重复保存
+ * 文本，摘要从源表读取。插入/修改/删除触发器保持索引与源表同步，建立时对已有的数据执行一次
+ * 重建(批量建立索引比逐行插入快得多)。
+ * 注:1.需要sqlite编译时开启FTS5(SQLITE_ENABLE_FTS5，3.9.0及以上)。
+ *    2.源表需要有rowid(不能是WITHOUT ROWID表)，建立的列不能配置透明压缩(setColumnCompression())。
+ *    3.已存在的索引不会被修改，列或分词器变化时需要先dropFullTextIndex()。
+ *    4.开启内存暂存的表，暂存的行在刷新到磁盘后才能被检索到。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnNames:建立索引的文本列
+ *@param:   tokenizer:分词器 例如"trigram"(任意子串匹配，sqlite3.34及以上)，为空使用默认的unicode61
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::createFullTextIndex(QString tableName, QList<QString> columnNames, QString tokenizer)
+{
+    if(columnNames.isEmpty())
+    {
+        qDebug()<<"create full text index error: no column...";
+        return false;
+    }
+    if(codecCount.load())
+    {
+        QReadLocker codecLocker(&codecLock);
+        QHash<QString,TableCodecs>::const_iterator iter = columnCodecs.constFind(tableName.toLower());
+        for(int i=0;iter != columnCodecs.constEnd() && i<columnNames.size();i++)
+        {
+            if(iter->codecs.contains(columnNames.at(i).trimmed().toLower()))
+            {
+                qDebug()<<"create full text index error: column is compressed..."<<tableName<<columnNames.at(i);
+                return false;
+            }
+        }
+    }
+    prepareStagedModify(tableName);//暂存的数据先写入源表，重建时一并建立索引
+    QString ftsTableName = tableName+FTS_SUFFIX;
+    QString columnNamesStr = QStringList(columnNames).join(",");
+    QStringList newValues;
+    QStringList oldValues;
+    for(int i=0;i<columnNames.size();i++)
+    {
+        newValues<<"new."+columnNames.at(i);
+        oldValues<<"old."+columnNames.at(i);
+    }
+    QString tokenizeStr = tokenizer.isEmpty() ? QString() : QString(",tokenize='%1'").arg(tokenizer);
+    QStringList sqls;
+    sqls<<QString("create virtual table %1 using fts5(%2,content='%3',content_rowid='rowid'%4);")
+          .arg(ftsTableName,columnNamesStr,tableName,tokenizeStr);
+    //外部内容表删除索引时需要提供旧的内容
+    sqls<<QString("create trigger if not exists %1_ai after insert on %2 begin "
+                  "insert into %1(rowid,%3) values(new.rowid,%4); end;")
+          .arg(ftsTableName,tableName,columnNamesStr,newValues.join(","));
+    sqls<<QString("create trigger if not exists %1_ad after delete on %2 begin "
+                  "insert into %1(%1,rowid,%3) values('delete',old.rowid,%4); end;")
+          .arg(ftsTableName,tableName,columnNamesStr,oldValues.join(","));
+    sqls<<QString("create trigger if not exists %1_au after update on %2 begin "
+                  "insert into %1(%1,rowid,%3) values('delete',old.rowid,%4); "
+                  "insert into %1(rowid,%3) values(new.rowid,%5); end;")
+          .arg(ftsTableName,tableName,columnNamesStr,oldValues.join(","),newValues.join(","));
+    sqls<<QString("insert into %1(%1) values('rebuild');").arg(ftsTableName);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<ftsTableName);//写锁
+#endif
+    QStringList tableColumns = tableColumnNames(tableName);
+    for(int i=0;i<columnNames.size();i++)
+    {
+        if(!tableColumns.contains(columnNames.at(i).trimmed(),Qt::CaseInsensitive))
+        {
+            qDebug()<<"create full text index error: table or column doesn't exist..."<<tableName<<columnNames.at(i);
+            return false;
+        }
+    }
+    if(!tableColumnNames(ftsTableName).isEmpty())
+    {
+        return true;//索引已存在
+    }
+    if(!beginTransaction("create full text index transaction error:"))
+    {
+        return false;
+    }
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"create full text index error:"))
+        {
+            rollbackTransaction();
+            return false;
+        }
+    }
+    if(!commitTransaction("create full text index transaction error:"))
+    {
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   按源表的当前数据重建全文索引 索引与源表不一致时(例如建立触发器之前绕过
+ * 触发器修改了数据)使用
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::rebuildFullTextIndex(QString tableName)
+{
+    prepareStagedModify(tableName);//暂存的数据先写入源表
+    QString ftsTableName = tableName+FTS_SUFFIX;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList()<<tableName,QStringList()<<ftsTableName);
+#endif
+    return execSql(QString("insert into %1(%1) values('rebuild');").arg(ftsTableName),QVariantList(),
+                   "rebuild full text index error:");
+}
+/*
+ *@brief:   删除表的全文索引及同步触发器 源表数据不受影响
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::dropFullTextIndex(QString tableName)
+{
+    QString ftsTableName = tableName+FTS_SUFFIX;
+    QStringList sqls;
+    sqls<<QString("drop trigger if exists %1_ai;").arg(ftsTableName)
+        <<QString("drop trigger if exists %1_au;").arg(ftsTableName)
+        <<QString("drop trigger if exists %1_ad;").arg(ftsTableName)
+        <<QString("drop table if exists %1;").arg(ftsTableName);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<ftsTableName);//写锁
+#endif
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"drop full text index error:"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   全文检索 在全文索引中查找匹配的行，按bm25相关度排序
+ *@date:    2026.10.19
+ *@param:   tableName:表名 需要已调用createFullTextIndex()
+ *@param:   query:FTS5查询语句 例如 "error"、"disk AND full"、"connect*"、"\"time out\""，
+ *  可以用"列名:词"限定列
+ *@param:   limit:最多返回的结果数
+ *@return:  QList<FullTextMatch>:匹配的rowid、相关度和摘要 没有匹配或失败时为空
+ */
+QList<FullTextMatch> DatabaseManager::search(QString tableName, QString query, int limit)
+{
+    QList<FullTextMatch> matches;
+    QString ftsTableName = tableName+FTS_SUFFIX;
+    //摘要的列号为-1表示自动选择匹配最多的列
+    QString selectSql = QString("select rowid,rank,snippet(%1,-1,'[',']','...',%2) from %1 "
+                                "where %1 match ? order by rank limit ?;").arg(ftsTableName).arg(FTS_SNIPPET_TOKENS);
+    QVariantList values;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,QStringList()<<tableName<<ftsTableName,QStringList());//读锁
+#endif
+        if(!execSelect(selectSql,QVariantList()<<query<<limit,values,0,-1,"full text search error:"))
+        {
+            return matches;
+        }
+    }
+    for(int i=0;i+2<values.size();i+=3)
+    {
+        FullTextMatch match;
+        match.rowid = values.at(i).toLongLong();
+        match.rank = values.at(i+1).toDouble();
+        match.snippet = values.at(i+2).toString();
+        matches.append(match);
+    }
+    return matches;
+}
+/*
+ *@brief:   为表的数值列建立多维范围索引 索引表(表名_rtree)为R*Tree虚拟表，每一维以源列的值
+ * 作为上下界(点数据)，列名为"源列名_min/_max"。插入/修改/删除触发器保持索引与源表同步，
+ * 任一维为NULL的行不进入索引。建立时对已有的数据批量建立索引。
+ * 注:1.需要sqlite编译时开启R*Tree(SQLITE_ENABLE_RTREE)，源表需要有rowid。
+ *    2.R*Tree默认以32位浮点数保存坐标，较大的数值(如秒级时间戳)精度不足，查询时会在源表上
+ *      按原值再过滤一次，结果是准确的，只是索引的筛选效果变差；各维都是整数时可以使用isInteger
+ *      (rtree_i32，32位整数)。
+ *    3.已存在的索引不会被修改，列变化时需要先dropRangeIndex()。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnNames:建立索引的数值列 1-5列，每列为一维
+ *@param:   isInteger:各维是否都是32位范围内的整数
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::createRangeIndex(QString tableName, QList<QString> columnNames, bool isInteger)
+{
+    if(columnNames.isEmpty() || columnNames.size() > 5)
+    {
+        qDebug()<<"create range index error: 1-5 columns are required..."<<columnNames;
+        return false;
+    }
+    prepareStagedModify(tableName);//暂存的数据先写入源表，一并建立索引
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+    QStringList rtreeColumns;
+    QStringList newValues;
+    QStringList sourceValues;
+    QStringList newConditions;
+    QStringList sourceConditions;
+    for(int i=0;i<columnNames.size();i++)
+    {
+        QString columnName = columnNames.at(i).trimmed();
+        rtreeColumns<<columnName+"_min"<<columnName+"_max";
+        newValues<<"new."+columnName<<"new."+columnName;
+        sourceValues<<columnName<<columnName;
+        newConditions<<"new."+columnName+" is not null";
+        sourceConditions<<columnName+" is not null";
+    }
+    QStringList sqls;
+    sqls<<QString("create virtual table %1 using %2(id,%3);")
+          .arg(rtreeTableName,isInteger ? "rtree_i32" : "rtree",rtreeColumns.join(","));
+    sqls<<QString("create trigger if not exists %1_ai after insert on %2 begin "
+                  "insert into %1 select new.rowid,%3 where %4; end;")
+          .arg(rtreeTableName,tableName,newValues.join(","),newConditions.join(" and "));
+    sqls<<QString("create trigger if not exists %1_ad after delete on %2 begin "
+                  "delete from %1 where id=old.rowid; end;").arg(rtreeTableName,tableName);
+    sqls<<QString("create trigger if not exists %1_au after update on %2 begin "
+                  "delete from %1 where id=old.rowid; "
+                  "insert into %1 select new.rowid,%3 where %4; end;")
+          .arg(rtreeTableName,tableName,newValues.join(","),newConditions.join(" and "));
+    sqls<<QString("insert into %1 select rowid,%2 from %3 where %4;")
+          .arg(rtreeTableName,sourceValues.join(","),tableName,sourceConditions.join(" and "));
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<rtreeTableName);//写锁
+#endif
+    QStringList tableColumns = tableColumnNames(tableName);
+    for(int i=0;i<columnNames.size();i++)
+    {
+        if(!tableColumns.contains(columnNames.at(i).trimmed(),Qt::CaseInsensitive))
+        {
+            qDebug()<<"create range index error: table or column doesn't exist..."<<tableName<<columnNames.at(i);
+            return false;
+        }
+    }
+    if(!tableColumnNames(rtreeTableName).isEmpty())
+    {
+        return true;//索引已存在
+    }
+    if(!beginTransaction("create range index transaction error:"))
+    {
+        return false;
+    }
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"create range index error:"))
+        {
+            rollbackTransaction();
+            return false;
+        }
+    }
+    if(!commitTransaction("create range index transaction error:"))
+    {
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   按源表的当前数据重建多维范围索引
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::rebuildRangeIndex(QString tableName)
+{
+    prepareStagedModify(tableName);
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList()<<tableName,QStringList()<<rtreeTableName);
+#endif
+    QStringList rtreeColumns = tableColumnNames(rtreeTableName);
+    if(rtreeColumns.size() < 3)
+    {
+        qDebug()<<"rebuild range index error: range index doesn't exist..."<<tableName;
+        return false;
+    }
+    QStringList sourceValues;
+    QStringList sourceConditions;
+    for(int i=1;i+1<rtreeColumns.size();i+=2)
+    {
+        QString columnName = rtreeColumns.at(i).left(rtreeColumns.at(i).size()-4);//去掉"_min"
+        sourceValues<<columnName<<columnName;
+        sourceConditions<<columnName+" is not null";
+    }
+    if(!beginTransaction("rebuild range index transaction error:"))
+    {
+        return false;
+    }
+    if(!execSql(QString("delete from %1;").arg(rtreeTableName),QVariantList(),"rebuild range index error:") ||
+       !execSql(QString("insert into %1 select rowid,%2 from %3 where %4;")
+                .arg(rtreeTableName,sourceValues.join(","),tableName,sourceConditions.join(" and ")),
+                QVariantList(),"rebuild range index error:"))
+    {
+        rollbackTransaction();
+        return false;
+    }
+    if(!commitTransaction("rebuild range index transaction error:"))
+    {
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   删除表的多维范围索引及同步触发器 源表数据不受影响
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::dropRangeIndex(QString tableName)
+{
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+    QStringList sqls;
+    sqls<<QString("drop trigger if exists %1_ai;").arg(rtreeTableName)
+        <<QString("drop trigger if exists %1_au;").arg(rtreeTableName)
+        <<QString("drop trigger if exists %1_ad;").arg(rtreeTableName)
+        <<QString("drop table if exists %1;").arg(rtreeTableName);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,QStringList(),QStringList()<<tableName<<rtreeTableName);//写锁
+#endif
+    for(int i=0;i<sqls.size();i++)
+    {
+        if(!execSql(sqls.at(i),QVariantList(),"drop range index error:"))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   多维范围查询 返回各维都在范围内的行的rowid(按R*Tree的遍历顺序，不排序)
+ *@date:    2026.10.19
+ *@param:   tableName:表名 需要已调用createRangeIndex()
+ *@param:   minValues:每一维的下界 按建立索引的列顺序，可以少于维数(其余维不限)
+ *@param:   maxValues:每一维的上界
+ *@param:   limit:最多返回的行数 -1表示全部
+ *@return:  QList<qint64>:rowid列表 失败时为空
+ */
+QList<qint64> DatabaseManager::selectRangeRowids(QString tableName, QVariantList minValues, QVariantList maxValues, int limit)
+{
+    QList<qint64> rowids;
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+    QVariantList values;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,QStringList()<<tableName<<rtreeTableName,QStringList());//读锁
+#endif
+        QString clauseSql;
+        QVariantList bindValues;
+        if(!rangeQueryClause(tableName,minValues,maxValues,clauseSql,bindValues))
+        {
+            return rowids;
+        }
+        bindValues<<limit;
+        if(!execSelect(QString("select r.id %1 limit ?;").arg(clauseSql),bindValues,values,0,-1,"select range error:"))
+        {
+            return rowids;
+        }
+    }
+    for(int i=0;i<values.size();i++)
+    {
+        rowids.append(values.at(i).toLongLong());
+    }
+    return rowids;
+}
+/*
+ *@brief:   多维范围查询 返回各维都在范围内的行的数据
+ *@date:    2026.10.19
+ *@param:   tableName:表名 需要已调用createRangeIndex()
+ *@param:   columnNames:查询的列名 为空则查询整行数据
+ *@param:   minValues:每一维的下界
+ *@param:   maxValues:每一维的上界
+ *@param:   limit:最多返回的行数 -1表示全部
+ *@return:  QList<QVariantList>:每个元素为一行 失败时为空
+ */
+QList<QVariantList> DatabaseManager::selectRangeRows(QString tableName, QList<QString> columnNames, QVariantList minValues,
+                                                     QVariantList maxValues, int limit)
+{
+    QList<QVariantList> rows;
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+    QStringList selectColumns;
+    for(int i=0;i<columnNames.size();i++)
+    {
+        selectColumns<<"t."+columnNames.at(i);
+    }
+    QString columnNamesStr = selectColumns.isEmpty() ? QString("t.*") : selectColumns.join(",");
+    QVariantList values;
+    int columnCount = 0;
+    {
+#ifdef MT_SAFE
+        TableLocker locker(&lockManager,QStringList()<<tableName<<rtreeTableName,QStringList());//读锁
+#endif
+        QString clauseSql;
+        QVariantList bindValues;
+        if(!rangeQueryClause(tableName,minValues,maxValues,clauseSql,bindValues))
+        {
+            return rows;
+        }
+        bindValues<<limit;
+        if(!execSelect(QString("select %1 %2 limit ?;").arg(columnNamesStr,clauseSql),bindValues,values,
+                       &columnCount,-1,"select range error:"))
+        {
+            return rows;
+        }
+    }
+    for(int i=0;columnCount > 0 && i+columnCount<=values.size();i+=columnCount)
+    {
+        rows.append(values.mid(i,columnCount));
+    }
+    return rows;
+}
+/*
+ *@brief:   开启数据变更通知 在连接上安装sqlite3的update/commit/rollback钩子:
+ * update钩子记录当前事务中每一行的插入/修改/删除，提交时合并到待发送的列表，回滚时丢弃，
+ * 之后在DatabaseManager所在的线程中发送tableChanged()信号，界面可以只刷新变化的表和行。
+ * 注:1.需要连接已创建，且DatabaseManager所在的线程有事件循环。
+ *    2.sqlite的update钩子不支持WITHOUT ROWID表，也不会报告on conflict replace删除的行。
+ *    3.只通知主数据库(main)中的表。内存暂存的表在写入暂存表时不通知，刷新到磁盘时按
+ *      写入原表的新rowid通知插入；附加数据库、临时表的变化不通知。
+ *@date:    2026.10.19
+ *@param:   maxRowids:每个表每种操作最多记录的rowid数，超过后只通知整表变化
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::enableChangeNotification(int maxRowids)
+{
+#ifdef SQLITE_NATIVE_API
+    sqlite3 *handle = sqliteHandle();
+    if(!handle)
+    {
+        qDebug()<<"enable change notification error: sqlite3 handle isn't available...";
+        return false;
+    }
+    qRegisterMetaType<QList<TableChange> >("QList<TableChange>");//跨线程连接信号需要注册
+    {
+        QMutexLocker locker(&changeMutex);
+        maxChangeRowids = qMax(maxRowids,0);
+        isChangeNotificationEnabled = true;
+    }
+    sqlite3_update_hook(handle,&DatabaseManager::updateHookCallback,this);
+    sqlite3_commit_hook(handle,&DatabaseManager::commitHookCallback,this);
+    sqlite3_rollback_hook(handle,&DatabaseManager::rollbackHookCallback,this);
+    return true;
+#else
+    Q_UNUSED(maxRowids);
+    qDebug()<<"enable change notification error: SQLITE_NATIVE_API isn't defined...";
+    return false;
+#endif
+}
+/*
+ *@brief:   关闭数据变更通知 移除钩子并丢弃未发送的变更
+ *@date:    2026.10.19
+ */
+void DatabaseManager::disableChangeNotification()
+{
+    {
+        QMutexLocker locker(&changeMutex);
+        if(!isChangeNotificationEnabled)
+        {
+            return;
+        }
+        isChangeNotificationEnabled = false;
+        uncommittedChanges.clear();
+        committedChanges.clear();
+    }
+#ifdef SQLITE_NATIVE_API
+    sqlite3 *handle = sqliteHandle();
+    if(handle)
+    {
+        sqlite3_update_hook(handle,0,0);
+        sqlite3_commit_hook(handle,0,0);
+        sqlite3_rollback_hook(handle,0,0);
+    }
+#endif
+}
+/*
+ *@brief:   设置是否使用sqlite3原生接口执行语句 默认使用，关闭后所有语句都通过QSqlQuery
+ * 执行，可用于对比两者的性能或排查问题
+ *@date:    2026.10.19
+ *@param:   enabled:true=使用原生接口(需要SQLITE_NATIVE_API且句柄可用) false=使用QSqlQuery
+ */
+void DatabaseManager::setNativeApiEnabled(bool enabled)
+{
+    nativeApiEnabled = enabled;
+}
+/*
+ *@brief:   设置数据库被锁定(其他连接或进程正在写入)时的等待重试策略
+ * 原生接口可用时，忙处理器按当前语句是查询还是写操作选择策略，以带随机抖动的指数退避重试，
+ * 等待和重试计入busyStats()。否则只能设置统一的等待期限(pragma busy_timeout，取写策略的期限)，
+ * 也没有统计。
+ * 注:1.WAL模式下读操作不会被写操作阻塞，主要是写操作之间的等待。
+ *    2.sqlite检测到等待可能死锁时(例如读事务升级为写事务)直接返回忙，不调用忙处理器。
+ *    3.等待期间持有连接的互斥锁，同一连接的其他线程也会等待。
+ *@date:    2026.10.19
+ *@param:   readPolicy:查询的策略
+ *@param:   writePolicy:写操作及其他语句(建表、提交事务等)的策略
+ */
+void DatabaseManager::setBusyRetryPolicy(BusyRetryPolicy readPolicy, BusyRetryPolicy writePolicy)
+{
+    {
+        QMutexLocker busyLocker(&busyMutex);
+        readBusyPolicy = readPolicy;
+        writeBusyPolicy = writePolicy;
+    }
+    if(db.isOpen())
+    {
+        installBusyHandler();
+    }
+}
+/*
+ *@brief:   获取数据库锁等待的统计
+ *@date:    2026.10.19
+ *@param:   access:查询或写操作的统计
+ *@param:   reset:获取后是否清零
+ *@return:  BusyStats:等待统计
+ */
+BusyStats DatabaseManager::busyStats(AccessType access, bool reset)
+{
+    QMutexLocker busyLocker(&busyMutex);
+    BusyStats &stats = access == ReadAccess ? readBusyStats : writeBusyStats;
+    BusyStats result = stats;
+    if(reset)
+    {
+        stats = BusyStats();
+    }
+    return result;
+}
+/*
+ *@brief:   开启事务 所有线程共用一个连接，同一时刻只能有一个事务。先获取事务互斥，其他线程的
+ * 事务或写语句等待当前事务结束，而不是让第二个BEGIN失败后以自动提交的方式混入当前事务。
+ * 成功时保持互斥锁，必须调用commitTransaction()或rollbackTransaction()结束。
+ * 调用者应先加表锁再开启事务，事务期间不能再加表锁(保证加锁顺序一致)
+ *@date:    2026.10.19
+ *@param:   errorTag:失败时打印的错误前缀
+ *@return:  返回值为布尔类型，true:成功，false:失败(未持有互斥锁)
+ */
+bool DatabaseManager::beginTransaction(const char *errorTag)
+{
+    transactionMutex.lock();
+    if(!db.transaction())
+    {
+        qDebug()<<errorTag<<db.lastError();
+        transactionMutex.unlock();
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   提交事务 提交失败时回滚，之后释放事务互斥
+ *@date:    2026.10.19
+ *@param:   errorTag:失败时打印的错误前缀
+ *@return:  返回值为布尔类型，true:成功，false:失败(已回滚)
+ */
+bool DatabaseManager::commitTransaction(const char *errorTag)
+{
+    bool isSuccess = db.commit();
+    if(!isSuccess)
+    {
+        qDebug()<<errorTag<<db.lastError();
+        db.rollback();
+    }
+    transactionMutex.unlock();
+    return isSuccess;
+}
+//回滚事务并释放事务互斥
+void DatabaseManager::rollbackTransaction()
+{
+    db.rollback();
+    transactionMutex.unlock();
+}
+/*
+ *@brief:   原生接口当前是否可用 缓存使用的句柄来自sqliteHandle()，驱动内置的sqlite3与
+ * 本程序链接的库版本不一致时句柄为空，所有语句自动回退到QSqlQuery执行
+ *@date:    2026.10.19
+ *@return:  bool:true=语句通过sqlite3_stmt执行
+ */
+bool DatabaseManager::isNativeApiAvailable()
+{
+#ifdef SQLITE_NATIVE_API
+    return nativeApiEnabled && statementCache.handle() != 0;
+#else
+    return false;
+#endif
+}
+/*
+ *@brief:   执行一条不返回结果集的sql语句 原生接口可用时使用缓存的预处理语句，
+ * 否则通过QSqlQuery执行。该方法不加锁，由调用者负责
+ *@date:    2026.10.19
+ *@param:   sql:sql语句
+ *@param:   bindValues:按顺序绑定到占位符的值，为空表示没有占位符
+ *@param:   errorTag:执行失败时打印的错误前缀
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::execSql(const QString &sql, const QVariantList &bindValues, const char *errorTag)
+{
+    QMutexLocker transactionLocker(&transactionMutex);//不能混入其他线程正在进行的事务
+    BusyAccessScope busyScope(WriteAccess);
+#ifdef SQLITE_NATIVE_API
+    if(isNativeApiAvailable())
+    {
+        SqliteStatement statement(&statementCache,sql);
+        threadRowsAffected = 0;
+        //影响的行数在执行的同一临界区内读取
+        if(!statement.isValid() || !statement.bindValues(bindValues) || !statement.exec(&threadRowsAffected))
+        {
+            qDebug()<<errorTag<<statement.lastError();
+            qDebug()<<"error sql:"<<sql;
+            return false;
+        }
+        return true;
+    }
+    //驱动内置的sqlite3可用时，执行和读取影响的行数同样放在连接的互斥锁内
+    sqlite3_mutex *connectionMutex = statementCache.handle() ? sqlite3_db_mutex(statementCache.handle()) : 0;
+    sqlite3_mutex_enter(connectionMutex);
+#endif
+    //否则依靠transactionMutex，所有写语句都经过execSql()/execBatchSql()并持有该锁，
+    //查询语句不会改变影响的行数
+    QSqlQuery query(db);//创建sql语句执行对象
+    bool isSuccess;
+    threadRowsAffected = 0;
+    if(bindValues.isEmpty())
+    {
+        isSuccess = query.exec(sql);
+    }
+    else
+    {
+        isSuccess = query.prepare(sql);
+        for(int i=0;isSuccess && i<bindValues.size();i++)
+        {
+            query.addBindValue(bindValues.at(i));
+        }
+        isSuccess = isSuccess && query.exec();
+    }
+    if(isSuccess)
+    {
+        threadRowsAffected = qMax(0,query.numRowsAffected());
+    }
+#ifdef SQLITE_NATIVE_API
+    sqlite3_mutex_leave(connectionMutex);
+#endif
+    if(!isSuccess)
+    {
+        qDebug()<<errorTag<<query.lastError();
+        qDebug()<<"error sql:"<<sql;
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   以批处理的方式执行一条sql语句 columnValues的每一项为一个占位符对应的一列值，
+ * 原生接口下同一条预处理语句逐行重新绑定执行。该方法不加锁也不开启事务，由调用者负责
+ *@date:    2026.10.19
+ *@param:   sql:带占位符的sql语句
+ *@param:   columnValues:按列组织的绑定值，每列的行数必须相同
+ *@param:   errorTag:执行失败时打印的错误前缀
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::execBatchSql(const QString &sql, const QList<QVariantList> &columnValues, const char *errorTag)
+{
+    QMutexLocker transactionLocker(&transactionMutex);//不能混入其他线程正在进行的事务
+    BusyAccessScope busyScope(WriteAccess);
+#ifdef SQLITE_NATIVE_API
+    if(isNativeApiAvailable())
+    {
+        SqliteStatement statement(&statementCache,sql);
+        int rowCount = columnValues.isEmpty() ? 0 : columnValues.first().size();
+        bool isSuccess = statement.isValid();
+        for(int row=0;isSuccess && row<rowCount;row++)
+        {
+            for(int column=0;isSuccess && column<columnValues.size();column++)
+            {
+                isSuccess = statement.bindValue(column,columnValues.at(column).at(row));
+            }
+            isSuccess = isSuccess && statement.exec();
+        }
+        if(!isSuccess)
+        {
+            qDebug()<<errorTag<<statement.lastError();
+            qDebug()<<"error sql:"<<sql;
+            return false;
+        }
+        return true;
+    }
+#endif
+    QSqlQuery query(db);//创建sql语句执行对象
+    if(!query.prepare(sql))
+    {
+        qDebug()<<errorTag<<query.lastError();
+        qDebug()<<"error sql:"<<sql;
+        return false;
+    }
+    for(int i=0;i<columnValues.size();i++)
+    {
+        query.addBindValue(columnValues.at(i));
+    }
+    if(!query.execBatch())//批处理
+    {
+        qDebug()<<errorTag<<query.lastError();
+        qDebug()<<"error sql:"<<sql;
+        return false;
+    }
+    return true;
+}
+/*
+ *@brief:   执行查询语句，结果按行依次展开保存到values中 该方法不加锁，由调用者负责
+ *@date:    2026.10.19
+ *@param:   sql:查询语句
+ *@param:   bindValues:按顺序绑定到占位符的值，为空表示没有占位符
+ *@param:   values:保存结果，第row行第column列为values[row*columnCount+column]
+ *@param:   columnCount:返回结果集一条记录的字段数，不需要时传0
+ *@param:   maxRows:最多读取的行数，-1表示全部
+ *@param:   errorTag:执行失败时打印的错误前缀
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::execSelect(const QString &sql, const QVariantList &bindValues, QVariantList &values,
+                                 int *columnCount, int maxRows, const char *errorTag)
+{
+    BusyAccessScope busyScope(ReadAccess);
+    int from = values.size();
+#ifdef SQLITE_NATIVE_API
+    if(isNativeApiAvailable())
+    {
+        SqliteStatement statement(&statementCache,sql);
+        if(!statement.isValid() || !statement.bindValues(bindValues))
+        {
+            qDebug()<<errorTag<<statement.lastError();
+            qDebug()<<"error sql:"<<sql;
+            return false;
+        }
+        int count = statement.columnCount();
+        if(columnCount)
+        {
+            *columnCount = count;
+        }
+        for(int row=0;(maxRows<0 || row<maxRows) && statement.next();row++)
+        {
+            for(int i=0;i<count;i++)
+            {
+                values.append(statement.value(i));
+            }
+        }
+        if(statement.hasError())
+        {
+            qDebug()<<errorTag<<statement.lastError();
+            qDebug()<<"error sql:"<<sql;
+            return false;
+        }
+        decompressValues(values,from);
+        return true;
+    }
+#endif
+    QSqlQuery query(db);//创建sql语句执行对象
+    query.setForwardOnly(true);//设置结果集仅向前查询，内存不需要缓存结果，提高效率
+    bool isSuccess;
+    if(bindValues.isEmpty())
+    {
+        isSuccess = query.exec(sql);
+    }
+    else
+    {
+        isSuccess = query.prepare(sql);
+        for(int i=0;isSuccess && i<bindValues.size();i++)
+        {
+            query.addBindValue(bindValues.at(i));
+        }
+        isSuccess = isSuccess && query.exec();
+    }
+    if(!isSuccess)
+    {
+        qDebug()<<errorTag<<query.lastError();
+        qDebug()<<"error sql:"<<sql;
+        return false;
+    }
+    int count = query.record().count();//结果集一条记录的字段数
+    if(columnCount)
+    {
+        *columnCount = count;
+    }
+    for(int row=0;(maxRows<0 || row<maxRows) && query.next();row++)
+    {
+        for(int i=0;i<count;i++)
+        {
+            values.append(query.value(i));
+        }
+    }
+    decompressValues(values,from);
+    return true;
+}
+/*
+ *@brief:   取消单个表的暂存 删除内存数据库中的暂存表并移出列表，最后一个表移出后分离
+ * 内存数据库。调用者持有数据库独占锁，暂存的数据已刷新
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::unstageTable(const QString &tableName)
+{
+    if(!execSql(QString("drop table if exists staging.%1;").arg(tableName),QVariantList(),"drop staging table error:"))
+    {
+        return false;
+    }
+    bool isEmpty;
+    {
+        QMutexLocker stagingLocker(&stagingMutex);
+        for(int i=stagedTables.size()-1;i>=0;i--)
+        {
+            if(stagedTables.at(i).compare(tableName,Qt::CaseInsensitive) == 0)
+            {
+                stagedTables.removeAt(i);
+            }
+        }
+        stagedTableCount.storeRelease(stagedTables.size());
+        isEmpty = stagedTables.isEmpty();
+    }
+    return !isEmpty || detachDB("staging");
+}
+/*
+ *@brief:   由原表结构生成暂存表的建表语句 保留列的类型、默认值和非空约束，插入时省略的列
+ * 在暂存表中就取得默认值，刷新时不会以NULL写入原表。主键、唯一、检查等约束不保留(暂存表
+ * 只有未刷新的数据，无法检查)；integer primary key列不加非空约束，省略时保持NULL，刷新时
+ * 由原表分配rowid
+ *@date:    2026.10.19
+ *@param:   tableName:原表名
+ *@return:  QString:建表语句 读取表结构失败时为空
+ */
+QString DatabaseManager::stagingCreateSql(const QString &tableName)
+{
+    QVariantList tableInfo;
+    int infoColumnCount = 0;
+    //table_info每行为(cid,name,type,notnull,dflt_value,pk)
+    if(!execSelect(QString("pragma main.table_info(%1);").arg(tableName),QVariantList(),tableInfo,
+                   &infoColumnCount,-1,"select table info error:") || infoColumnCount < 6 || tableInfo.isEmpty())
+    {
+        return QString();
+    }
+    int pkCount = 0;
+    for(int i=0;i<tableInfo.size();i+=infoColumnCount)
+    {
+        if(tableInfo.at(i+5).toInt() > 0)
+        {
+            pkCount++;
+        }
+    }
+    QStringList columnDefs;
+    for(int i=0;i<tableInfo.size();i+=infoColumnCount)
+    {
+        QString type = tableInfo.at(i+2).toString();
+        QString columnDef = tableInfo.at(i+1).toString()+" "+type;
+        bool isRowidAlias = pkCount == 1 && tableInfo.at(i+5).toInt() == 1 &&
+                type.compare("integer",Qt::CaseInsensitive) == 0;
+        if(tableInfo.at(i+3).toInt() && !isRowidAlias)
+        {
+            columnDef.append(" not null");
+        }
+        if(!tableInfo.at(i+4).isNull())
+        {
+            columnDef.append(QString(" default (%1)").arg(tableInfo.at(i+4).toString()));
+        }
+        columnDefs.append(columnDef);
+    }
+    return QString("create table if not exists staging.%1(%2);").arg(tableName,columnDefs.join(","));
+}
+bool DatabaseManager::isStagedTable(const QString &tableName)
+{
+    if(!stagedTableCount.load())
+    {
+        return false;//未开启暂存时不加锁
+    }
+    QMutexLocker stagingLocker(&stagingMutex);
+    return stagedTables.contains(tableName,Qt::CaseInsensitive);
+}
+//写入的表名 暂存表写入到内存数据库中的同名表
+QString DatabaseManager::stagingWriteTable(const QString &tableName)
+{
+    return isStagedTable(tableName) ? QString("staging.%1").arg(tableName) : tableName;
+}
+//查询的数据源 暂存表为磁盘表与暂存表的合并，并以原表名作为别名，条件中仍可使用原表名
+//合并后的子查询没有rowid，两个分支不选rowid是为了保持select *的列与原表一致
+QString DatabaseManager::stagingReadSource(const QString &tableName)
+{
+    if(!isStagedTable(tableName))
+    {
+        return tableName;
+    }
+    return QString("(select * from main.%1 union all select * from staging.%1) as %1").arg(tableName);
+}
+/*
+ *@brief:   暂存表写入前调用 暂存的行数达到阈值时先刷新，控制崩溃时的最大丢失行数
+ * 必须在加表锁之前调用
+ *@date:    2026.10.19
+ */
+void DatabaseManager::prepareStagedWrite(const QString &tableName)
+{
+    if(!isStagedTable(tableName))
+    {
+        return;
+    }
+    int flushRowCount;
+    {
+        QMutexLocker stagingLocker(&stagingMutex);
+        flushRowCount = stagingOptions.flushRowCount;
+    }
+    if(stagedRowCount.load() >= flushRowCount)
+    {
+        flushStaging();
+    }
+}
+/*
+ *@brief:   暂存表修改/删除前调用 先刷新，使修改作用于全部数据 必须在加表锁之前调用
+ *@date:    2026.10.19
+ */
+void DatabaseManager::prepareStagedModify(const QString &tableName)
+{
+    if(isStagedTable(tableName))
+    {
+        flushStaging();
+    }
+}
+
+void DatabaseManager::addStagedRows(const QString &tableName, int rowCount)
+{
+    if(isStagedTable(tableName))
+    {
+        stagedRowCount.fetchAndAddOrdered(rowCount);
+    }
+}
+QSharedPointer<TableMirror> DatabaseManager::findMirror(const QString &tableName)
+{
+    if(!mirrorCount.load())
+    {
+        return QSharedPointer<TableMirror>();
+    }
+    QReadLocker mirrorLocker(&mirrorLock);
+    return mirrors.value(tableName.toLower());
+}
+/*
+ *@brief:   从数据表加载整个镜像 调用者负责加锁
+ *@date:    2026.10.19
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool DatabaseManager::loadMirror(TableMirror *mirror, const QString &tableName)
+{
+    QString selectSql = QString("select %1 from %2;").arg(mirror->columns().join(","),stagingReadSource(tableName));
+    QVariantList values;
+    if(!execSelect(selectSql,QVariantList(),values,0,-1,"load table mirror error:"))
+    {
+        return false;
+    }
+    mirror->setRows(values);
+    return true;
+}
+/*
+ *@brief:   从镜像查询键值对应的行 不加表锁
+ *@date:    2026.10.19
+ *@param:   columnNames:查询的列名 为空表示整行
+ *@param:   values:返回的列数据，行不存在时为空
+ *@return:  bool:true=由镜像完成查询 false=表没有镜像或不能由镜像查询，需要执行sql
+ */
+bool DatabaseManager::selectMirror(const QString &tableName, const QList<QString> &columnNames, const QString &whereColName,
+                                   const QVariant &whereColValue, QVariantList &values)
+{
+    QSharedPointer<TableMirror> mirror = findMirror(tableName);
+    if(!mirror || whereColName.trimmed().compare(mirror->keyColumnName(),Qt::CaseInsensitive) != 0)
+    {
+        return false;
+    }
+    QList<int> columns;
+    for(int i=0;i<columnNames.size();i++)
+    {
+        int column = mirror->columnIndex(columnNames.at(i));
+        if(column < 0)
+        {
+            return false;//表达式或不存在的列，交给sql处理
+        }
+        columns.append(column);
+    }
+    mirror->select(whereColValue,columns,values);
+    return true;
+}
+/*
+ *@brief:   写操作成功后更新镜像 在写操作持有表锁时调用
+ * 条件为键值列且没有修改键值列时，只重新读取受影响的行，否则重新加载整个表
+ *@date:    2026.10.19
+ *@param:   tableName:表名 为空表示无法确定修改的表，重新加载所有镜像
+ *@param:   whereColName:写操作的条件列
+ *@param:   whereColValues:条件列的值
+ *@param:   changedColumns:修改的列
+ */
+void DatabaseManager::refreshMirror(const QString &tableName, const QString &whereColName, const QVariantList &whereColValues,
+                                    const QList<QString> &changedColumns)
+{
+    if(!mirrorCount.load())
+    {
+        return;
+    }
+    if(tableName.isEmpty())
+    {
+        QHash<QString,QSharedPointer<TableMirror> > allMirrors;
+        {
+            QReadLocker mirrorLocker(&mirrorLock);
+            allMirrors = mirrors;
+        }
+        QHash<QString,QSharedPointer<TableMirror> >::const_iterator it;
+        for(it=allMirrors.constBegin();it!=allMirrors.constEnd();++it)
+        {
+            if(!loadMirror(it.value().data(),it.key()))
+            {
+                unpinTable(it.key());//表被删除或改名，镜像失效
+            }
+        }
+        return;
+    }
+    QSharedPointer<TableMirror> mirror = findMirror(tableName);
+    if(!mirror)
+    {
+        return;
+    }
+    QString keyColumnName = mirror->keyColumnName();
+    bool isKeyChanged = false;
+    for(int i=0;i<changedColumns.size();i++)
+    {
+        if(changedColumns.at(i).trimmed().compare(keyColumnName,Qt::CaseInsensitive) == 0)
+        {
+            isKeyChanged = true;
+        }
+    }
+    //按键值刷新的行数较多时，直接重新加载整个表更快
+    if(isKeyChanged || whereColValues.isEmpty() || whereColValues.size() > MIRROR_ROW_REFRESH_LIMIT ||
+            whereColName.trimmed().compare(keyColumnName,Qt::CaseInsensitive) != 0)
+    {
+        loadMirror(mirror.data(),tableName);
+        return;
+    }
+    QString selectSql = QString("select %1 from %2 where %3=?;")
+            .arg(mirror->columns().join(","),stagingReadSource(tableName),keyColumnName);
+    for(int i=0;i<whereColValues.size();i++)
+    {
+        QVariantList rowValues;
+        if(!execSelect(selectSql,QVariantList()<<whereColValues.at(i),rowValues,0,1,"refresh table mirror error:"))
+        {
+            loadMirror(mirror.data(),tableName);
+            return;
+        }
+        if(rowValues.isEmpty())
+        {
+            mirror->removeRow(whereColValues.at(i));
+        }
+        else
+        {
+            mirror->setRow(whereColValues.at(i),rowValues);
+        }
+    }
+}
+/*
+ *@brief:   插入单条数据成功后更新镜像 从插入的值中找到键值，找不到时(例如自增主键)重新加载整个表
+ *@date:    2026.10.19
+ */
+void DatabaseManager::refreshMirrorRow(const QString &tableName, const QList<QString> &columnNames, const QVariantList &rowValues)
+{
+    QSharedPointer<TableMirror> mirror = findMirror(tableName);
+    if(!mirror)
+    {
+        return;
+    }
+    QString keyColumnName = mirror->keyColumnName();
+    int keyPosition = -1;
+    if(columnNames.isEmpty())
+    {
+        keyPosition = mirror->columnIndex(keyColumnName);
+    }
+    for(int i=0;i<columnNames.size();i++)
+    {
+        if(columnNames.at(i).trimmed().compare(keyColumnName,Qt::CaseInsensitive) == 0)
+        {
+            keyPosition = i;
+        }
+    }
+    if(keyPosition < 0 || keyPosition >= rowValues.size())
+    {
+        refreshMirror(tableName);
+        return;
+    }
+    refreshMirror(tableName,keyColumnName,QVariantList()<<rowValues.at(keyPosition));
+}
+bool DatabaseManager::hasColumnCompression(const QString &tableName)
+{
+    if(!codecCount.load())
+    {
+        return false;
+    }
+    QReadLocker codecLocker(&codecLock);
+    return columnCodecs.contains(tableName.toLower());
+}
+/*
+ *@brief:   压缩一行中配置了压缩的列 不修改调用者的数据
+ *@date:    2026.10.19
+ *@param:   columnNames:values对应的列名 为空表示按表中的顺序对应全部列
+ *@return:  QVariantList:要绑定的值 表没有压缩列时为原来的values
+ */
+QVariantList DatabaseManager::compressValues(const QString &tableName, const QList<QString> &columnNames, const QVariantList &values)
+{
+    if(!codecCount.load())
+    {
+        return values;
+    }
+    QReadLocker codecLocker(&codecLock);
+    QHash<QString,TableCodecs>::const_iterator iter = columnCodecs.constFind(tableName.toLower());
+    if(iter == columnCodecs.constEnd())
+    {
+        return values;
+    }
+    const QList<QString> &names = columnNames.isEmpty() ? iter->columnNames : columnNames;
+    QVariantList bindValues = values;
+    for(int i=0;i<bindValues.size() && i<names.size();i++)
+    {
+        QSharedPointer<ColumnCodec> codec = iter->codecs.value(names.at(i).trimmed().toLower());
+        if(codec)
+        {
+            bindValues[i] = codec->compress(bindValues.at(i));
+        }
+    }
+    return bindValues;
+}
+//按列存放的批量数据的压缩 参数含义同compressValues()
+QList<QVariantList> DatabaseManager::compressColumnValues(const QString &tableName, const QList<QString> &columnNames,
+                                                          const QList<QVariantList> &columnValues)
+{
+    if(!codecCount.load())
+    {
+        return columnValues;
+    }
+    QReadLocker codecLocker(&codecLock);
+    QHash<QString,TableCodecs>::const_iterator iter = columnCodecs.constFind(tableName.toLower());
+    if(iter == columnCodecs.constEnd())
+    {
+        return columnValues;
+    }
+    const QList<QString> &names = columnNames.isEmpty() ? iter->columnNames : columnNames;
+    QList<QVariantList> bindColumnValues = columnValues;
+    for(int i=0;i<bindColumnValues.size() && i<names.size();i++)
+    {
+        QSharedPointer<ColumnCodec> codec = iter->codecs.value(names.at(i).trimmed().toLower());
+        if(!codec)
+        {
+            continue;
+        }
+        QVariantList &values = bindColumnValues[i];
+        for(int row=0;row<values.size();row++)
+        {
+            values[row] = codec->compress(values.at(row));
+        }
+    }
+    return bindColumnValues;
+}
+/*
+ *@brief:   从另一个管理对象复制解压所需的预置字典 同一数据库的派生连接(读快照、启动时的
+ * 后台连接)没有自己的压缩配置，不复制时查询结果中是未解压的原始BLOB。派生连接只读，
+ * 不需要压缩列的配置
+ *@date:    2026.10.19
+ *@param:   source:主连接的管理对象
+ */
+void DatabaseManager::shareCodecDictionaries(DatabaseManager *source)
+{
+    QHash<quint32,QByteArray> dictionaries;
+    {
+        QReadLocker sourceLocker(&source->codecLock);
+        dictionaries = source->codecDictionaries;
+    }
+    QWriteLocker codecLocker(&codecLock);
+    QHash<quint32,QByteArray>::const_iterator iter = dictionaries.constBegin();
+    for(;iter != dictionaries.constEnd();++iter)
+    {
+        codecDictionaries.insert(iter.key(),iter.value());
+    }
+    if(source->isDecompressEnabled.loadAcquire())
+    {
+        isDecompressEnabled.storeRelease(1);
+    }
+}
+/*
+ *@brief:   解压查询结果中的压缩值 压缩值带有固定的头，不需要知道值属于哪一列，因此任意
+ * 查询(包括带表达式、多表的查询)的结果都可以统一在execSelect()中处理
+ *@date:    2026.10.19
+ *@param:   values:查询结果
+ *@param:   from:从该下标开始处理
+ */
+void DatabaseManager::decompressValues(QVariantList &values, int from)
+{
+    if(!isDecompressEnabled.load())
+    {
+        return;
+    }
+    QHash<quint32,QByteArray> dictionaries;
+    for(int i=from;i<values.size();i++)
+    {
+        if(!ColumnCodec::isCompressed(values.at(i)))
+        {
+            continue;
+        }
+        if(dictionaries.isEmpty())
+        {
+            QReadLocker codecLocker(&codecLock);
+            dictionaries = codecDictionaries;
+        }
+        values[i] = ColumnCodec::decompress(values.at(i),dictionaries);
+    }
+}
+/*
+ *@brief:   生成范围查询的from/where子句 R*Tree按重叠条件筛选后，再按源表的原值精确过滤
+ * (R*Tree的坐标精度有限，边界会向外取整)。cross join保证先遍历R*Tree再按rowid读取源表。
+ *@date:    2026.10.19
+ *@param:   clauseSql:返回"from ... where ..."
+ *@param:   bindValues:返回子句中占位符的值
+ *@return:  返回值为布尔类型，true:成功，false:索引不存在或上下界多于维数
+ */
+bool DatabaseManager::rangeQueryClause(const QString &tableName, const QVariantList &minValues, const QVariantList &maxValues,
+                                       QString &clauseSql, QVariantList &bindValues)
+{
+    QString rtreeTableName = tableName+RTREE_SUFFIX;
+    QStringList rtreeColumns = tableColumnNames(rtreeTableName);
+    int dimensions = (rtreeColumns.size()-1)/2;
+    if(dimensions < 1 || minValues.size() > dimensions || maxValues.size() > dimensions)
+    {
+        qDebug()<<"select range error: range index doesn't exist or too many bounds..."<<tableName;
+        return false;
+    }
+    QStringList conditions;
+    conditions<<"t.rowid=r.id";
+    QVariantList sourceBindValues;
+    QStringList sourceConditions;
+    for(int i=0;i<dimensions;i++)
+    {
+        QString minColumn = rtreeColumns.at(2*i+1);
+        QString maxColumn = rtreeColumns.at(2*i+2);
+        QString columnName = minColumn.left(minColumn.size()-4);//去掉"_min"
+        if(i < minValues.size() && minValues.at(i).isValid())
+        {
+            conditions<<"r."+maxColumn+">=?";
+            bindValues<<minValues.at(i);
+            sourceConditions<<"t."+columnName+">=?";
+            sourceBindValues<<minValues.at(i);
+        }
+        if(i < maxValues.size() && maxValues.at(i).isValid())
+        {
+            conditions<<"r."+minColumn+"<=?";
+            bindValues<<maxValues.at(i);
+            sourceConditions<<"t."+columnName+"<=?";
+            sourceBindValues<<maxValues.at(i);
+        }
+    }
+    conditions<<sourceConditions;
+    bindValues<<sourceBindValues;
+    clauseSql = QString("from %1 r cross join %2 t where %3").arg(rtreeTableName,tableName,conditions.join(" and "));
+    return true;
+}
+/*
+ *@brief:   查询表的列名 schemaName为空表示主数据库
+ *@date:    2026.10.19
+ *@return:  QStringList:列名 表不存在时为空
+ */
+QStringList DatabaseManager::tableColumnNames(const QString &tableName, const QString &schemaName)
+{
+    QString pragmaSql = schemaName.isEmpty() ? QString("pragma table_info(%1);").arg(tableName)
+                                             : QString("pragma %1.table_info(%2);").arg(schemaName,tableName);
+    QVariantList tableInfo;
+    int infoColumnCount = 0;
+    QStringList columnNames;
+    //table_info每行为(cid,name,type,notnull,dflt_value,pk)
+    if(!execSelect(pragmaSql,QVariantList(),tableInfo,&infoColumnCount,-1,"select table info error:"))
+    {
+        return columnNames;
+    }
+    for(int i=1;infoColumnCount>1 && i<tableInfo.size();i+=infoColumnCount)
+    {
+        columnNames.append(tableInfo.at(i).toString());
+    }
+    return columnNames;
+}
+/*
+ *@brief:   应用变更集中的一项变更 冲突:插入的行已存在、修改或删除的行不存在
+ *@date:    2026.10.19
+ *@param:   isConflict:返回是否发生了冲突
+ *@return:  返回值为布尔类型，true:成功(包括按策略跳过)，false:失败或Abort策略下发生冲突
+ */
+bool DatabaseManager::applyChangesetEntry(const Changeset &changeset, const ChangesetEntry &entry,
+                                          Changeset::ConflictPolicy policy, bool &isConflict)
+{
+    QVariantList existValues;
+    if(!execSelect(QString("select 1 from %1 where %2=?;").arg(changeset.tableName,changeset.keyColumnName),
+                   QVariantList()<<entry.keyValue,existValues,0,1,"apply changeset error:"))
+    {
+        return false;
+    }
+    bool isExist = !existValues.isEmpty();
+    isConflict = (entry.operation == ChangesetEntry::Insert) ? isExist : !isExist;
+    if(isConflict)
+    {
+        if(policy == Changeset::Abort)
+        {
+            qDebug()<<"apply changeset conflict:"<<changeset.tableName<<entry.operation<<entry.keyValue;
+            return false;
+        }
+        if(policy == Changeset::Omit || entry.operation == ChangesetEntry::Delete)
+        {
+            return true;//要删除的行已经不存在，Replace同样不需要处理
+        }
+    }
+    if(entry.operation == ChangesetEntry::Delete)
+    {
+        return execSql(QString("delete from %1 where %2=?;").arg(changeset.tableName,changeset.keyColumnName),
+                       QVariantList()<<entry.keyValue,"apply changeset error:");
+    }
+    if(entry.rowValues.size() != changeset.columnNames.size())
+    {
+        qDebug()<<"apply changeset error: row values don't match the columns..."<<entry.keyValue;
+        return false;
+    }
+    if(isExist)
+    {
+        QVariantList bindValues = entry.rowValues;
+        bindValues<<entry.keyValue;
+        return execSql(QString("update %1 set %2=? where %3=?;")
+                       .arg(changeset.tableName,changeset.columnNames.join("=?,"),changeset.keyColumnName),
+                       bindValues,"apply changeset error:");
+    }
+    return execSql(QString("insert into %1(%2) values(%3);")
+                   .arg(changeset.tableName,changeset.columnNames.join(","),getBindValuesStr(changeset.columnNames.size())),
+                   entry.rowValues,"apply changeset error:");
+}
+/*
+ *@brief:   安装忙处理器 没有原生接口时退化为pragma busy_timeout
+ *@date:    2026.10.19
+ */
+void DatabaseManager::installBusyHandler()
+{
+#ifdef SQLITE_NATIVE_API
+    sqlite3 *handle = sqliteHandle();
+    if(handle)
+    {
+        sqlite3_busy_handler(handle,&DatabaseManager::busyHandlerCallback,this);
+        return;
+    }
+#endif
+    int timeoutMsecs;
+    {
+        QMutexLocker busyLocker(&busyMutex);
+        timeoutMsecs = writeBusyPolicy.timeoutMsecs;
+    }
+    QSqlQuery query(db);//创建sql语句执行对象
+    if(!query.exec(QString("pragma busy_timeout = %1;").arg(timeoutMsecs)))
+    {
+        qDebug()<<"pragma busy_timeout error"<<query.lastError();
+    }
+}
+/*
+ *@brief:   忙处理器 数据库被锁定时由sqlite在执行语句的线程中回调
+ *@date:    2026.10.19
+ *@param:   context:DatabaseManager对象
+ *@param:   count:本次等待中已经回调的次数
+ *@return:  int:非0表示等待后重试，0表示放弃(语句返回SQLITE_BUSY)
+ */
+int DatabaseManager::busyHandlerCallback(void *context, int count)
+{
+    DatabaseManager *manager = static_cast<DatabaseManager *>(context);
+    BusyThreadState *state = busyThreadState();
+    bool isRead = state->access == ReadAccess;
+    QMutexLocker busyLocker(&manager->busyMutex);
+    BusyRetryPolicy policy = isRead ? manager->readBusyPolicy : manager->writeBusyPolicy;
+    BusyStats &stats = isRead ? manager->readBusyStats : manager->writeBusyStats;
+    if(count == 0)
+    {
+        stats.busyEvents++;
+        state->busyTimer.start();
+    }
+    qint64 remainMsecs = policy.timeoutMsecs-state->busyTimer.elapsed();
+    if(remainMsecs <= 0 || OperationDeadline::checkCurrent())//操作期限先到时同样放弃
+    {
+        stats.timeouts++;
+        return 0;
+    }
+    qint64 delayMsecs = qMin(qint64(policy.initialDelayMsecs)<<qMin(count,20),qint64(policy.maxDelayMsecs));
+    delayMsecs -= qint64(delayMsecs*qBound(0.0,policy.jitterRatio,1.0)*busyJitter(state)/1000.0);
+    delayMsecs = qBound(qint64(1),delayMsecs,remainMsecs);
+    stats.retries++;
+    stats.waitMsecs += delayMsecs;
+    busyLocker.unlock();
+    QThread::msleep(ulong(delayMsecs));
+    return 1;
+}
+/*
+ *@brief:   进度回调 执行语句期间每PROGRESS_CHECK_INSTRUCTIONS条虚拟机指令回调一次
+ *@date:    2026.10.19
+ *@param:   context:DatabaseManager对象
+ *@return:  int:非0表示中断语句(SQLITE_INTERRUPT)
+ */
+int DatabaseManager::progressHandlerCallback(void *context)
+{
+    Q_UNUSED(context);
+    return OperationDeadline::checkCurrent() ? 1 : 0;
+}
+/*
+ *@brief:   update钩子 记录当前事务中的行变更 不能在回调中执行sql
+ *@date:    2026.10.19
+ */
+void DatabaseManager::updateHookCallback(void *context, int operation, const char *databaseName, const char *tableName, qint64 rowid)
+{
+#ifdef SQLITE_NATIVE_API
+    //只通知主数据库 临时表只在本连接可见；暂存表(staging)的行在刷新写入原表时才通知，
+    //暂存rowid与原表无关，刷新时清空暂存表的删除也不应报告
+    if(qstrcmp(databaseName,"main") != 0)
+    {
+        return;
+    }
+    TableChange change;
+    change.tableName = QString::fromUtf8(tableName);
+    change.operation = (operation == SQLITE_INSERT) ? TableChange::Insert :
+                       (operation == SQLITE_UPDATE) ? TableChange::Update : TableChange::Delete;
+    change.rowids.append(rowid);
+    DatabaseManager *manager = static_cast<DatabaseManager *>(context);
+    QMutexLocker locker(&manager->changeMutex);
+    manager->mergeTableChange(manager->uncommittedChanges,change);
+#else
+    Q_UNUSED(context);
+    Q_UNUSED(operation);
+    Q_UNUSED(databaseName);
+    Q_UNUSED(tableName);
+    Q_UNUSED(rowid);
+#endif
+}
+/*
+ *@brief:   commit钩子 事务即将提交，把当前事务的变更合并到待发送的列表，并投递一次发送信号的事件
+ *@date:    2026.10.19
+ *@return:  int:0=允许提交
+ */
+int DatabaseManager::commitHookCallback(void *context)
+{
+    DatabaseManager *manager = static_cast<DatabaseManager *>(context);
+    QMutexLocker locker(&manager->changeMutex);
+    if(manager->uncommittedChanges.isEmpty())
+    {
+        return 0;
+    }
+    for(int i=0;i<manager->uncommittedChanges.size();i++)
+    {
+        manager->mergeTableChange(manager->committedChanges,manager->uncommittedChanges.at(i));
+    }
+    manager->uncommittedChanges.clear();
+    if(!manager->isChangeEmitPending)
+    {
+        manager->isChangeEmitPending = true;
+        //提交完成后再由事件循环发送，槽函数中可以直接查询数据库
+        QMetaObject::invokeMethod(manager,"emitTableChanges",Qt::QueuedConnection);
+    }
+    return 0;
+}
+
+void DatabaseManager::rollbackHookCallback(void *context)
+{
+    DatabaseManager *manager = static_cast<DatabaseManager *>(context);
+    QMutexLocker locker(&manager->changeMutex);
+    manager->uncommittedChanges.clear();//回滚的变更不通知
+}
+/*
+ *@brief:   合并变更 同一个表的同一种操作合并为一项，rowid数超过上限时改为整表变化
+ *@date:    2026.10.19
+ */
+void DatabaseManager::mergeTableChange(QList<TableChange> &changes, const TableChange &change)
+{
+    for(int i=0;i<changes.size();i++)
+    {
+        TableChange &existChange = changes[i];
+        if(existChange.operation != change.operation || existChange.tableName.compare(change.tableName,Qt::CaseInsensitive) != 0)
+        {
+            continue;
+        }
+        if(existChange.isAllRows)
+        {
+            return;
+        }
+        if(change.isAllRows || existChange.rowids.size()+change.rowids.size() > maxChangeRowids)
+        {
+            existChange.isAllRows = true;
+            existChange.rowids.clear();
+            return;
+        }
+        existChange.rowids.append(change.rowids);
+        return;
+    }
+    changes.append(change);
+    if(change.rowids.size() > maxChangeRowids)
+    {
+        changes.last().isAllRows = true;
+        changes.last().rowids.clear();
+    }
+}
+//删除整表数据(truncate优化)和删表不会触发update钩子，在操作成功后直接通知整表删除
+void DatabaseManager::notifyTableCleared(const QString &tableName)
+{
+    QMutexLocker locker(&changeMutex);
+    if(!isChangeNotificationEnabled)
+    {
+        return;
+    }
+    TableChange change;
+    change.tableName = tableName;
+    change.operation = TableChange::Delete;
+    change.isAllRows = true;
+    mergeTableChange(committedChanges,change);
+    if(!isChangeEmitPending)
+    {
+        isChangeEmitPending = true;
+        QMetaObject::invokeMethod(this,"emitTableChanges",Qt::QueuedConnection);
+    }
+}
+
+void DatabaseManager::emitTableChanges()
+{
+    QList<TableChange> changes;
+    {
+        QMutexLocker locker(&changeMutex);
+        changes.swap(committedChanges);
+        isChangeEmitPending = false;
+    }
+    if(!changes.isEmpty())
+    {
+        emit tableChanged(changes);
+    }
+}
+/*
+ *@brief:   生成sql语句的占位符串 例如count=3时返回"?,?,?"
+ *@date:    2026.10.19
+ *@param:   count:占位符的数量
+ *@return:  QString:以逗号分隔的占位符
+ */
+QString DatabaseManager::getBindValuesStr(int count)
+{
+    QString bindValuesStr;
+    bindValuesStr.reserve(count*2);
+    for(int i=0;i<count;i++)
+    {
+        bindValuesStr.append("?");
+        if(i != count-1)
+        {
+            bindValuesStr.append(",");
+        }
+    }
+    return bindValuesStr;
+}
@@ -3,6 +3,7 @@
  *@date:   2017.12.13
  *@brief:  该组件提供SQLite数据库的管理操作，包括表的定义以及数据的CRUD操作。经过对比
  * 考虑，该组件暂时主要针对单数据库的管理，对于多数据库管理，需要定义多个对象实现。
+ * 把一个逻辑表分散到多个数据库文件以提高写入吞吐量，见ShardedDatabaseManager。
  *
  * 另外通过帮助文档“Thread-Support in Qt Modules”可以了解到Qt 封装的SQL Module针对同
  * 一个数据库连接并不支持多线程，而该组件的设计初衷是“全局共用一个数据库连接操作一个
@@ -29,10 +30,28 @@
 #include <QReadWriteLock>
 #include <QString>
 #include <QList>
+#include <QHash>
 #include <QDebug>
 #include <QTime>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QStringList>
+#include "tablelockmanager.h"
+#include "arenaresultset.h"
+#include "sqliteblobdevice.h"
+#include "sqlitestatement.h"
+#include "recordmapping.h"
+#include "tablemirror.h"
+#include "changeset.h"
+#include "columncodec.h"
+#include "operationdeadline.h"
+#include <QSharedPointer>
+#include <vector>
 /* SQLite3只支持一写多读，在数据库本身是非线程安全的情况下，则可以打开该宏
- * 进行线程同步(读写锁)
+ * 进行线程同步(按表名加读写锁，见TableLockManager)
  * 因为我们的项目使用的sqlite3插件是串行模式，数据库内部接口已经加了锁，理论上
  * 就不需要我们在外边再加了。但是由于该组件的copyTable()函数的内部处理是由
  * 数据库的多条事务完成的，在其之间有可能被其他线程的数据库访问打断，造成数据
@@ -42,15 +61,152 @@
 */
 #define MT_SAFE
 
+//sqlite连接选项 在createSqliteConnection()打开数据库后设置
+struct SqliteConnectionOptions
+{
+    SqliteConnectionOptions():mmapSize(-1),cacheSize(0),walMode(false),backgroundIntegrityCheck(false){}
+    /*内存映射I/O的最大字节数(pragma mmap_size)，-1表示保持sqlite默认值(通常为0,即关闭)。
+     *开启后读取数据页直接访问映射的内存，省去read()系统调用及内核到页缓存的拷贝*/
+    qint64 mmapSize;
+    /*页缓存大小(pragma cache_size)，正数表示页数，负数表示KiB，0表示保持默认值(-2000,即约2MB)*/
+    int cacheSize;
+    bool walMode;//是否切换为WAL日志模式
+    /*快速启动 以下三项把启动时的耗时操作移出首次查询的路径，各阶段耗时见startupStats()。
+     *后台任务使用独立的连接，需要WAL模式(读不阻塞写)，否则完整性检测在打开时同步执行，预读跳过*/
+    bool backgroundIntegrityCheck;//在后台执行完整性检测，结果通过integrityChecked()信号通知
+    QStringList warmupStatements;//打开后立即预处理并放入语句缓存的热点语句(SQLITE_NATIVE_API)
+    QStringList prefetchTables;//在后台顺序读取这些表及其索引，把数据页预读到系统的文件缓存
+};
+
+//启动各阶段的耗时(微秒) 见SqliteConnectionOptions的快速启动选项
+struct StartupStats
+{
+    StartupStats():openUsecs(0),pragmaUsecs(0),warmupUsecs(0),readyUsecs(0),integrityCheckUsecs(-1),
+        prefetchUsecs(-1),warmedStatements(0),isIntegrity(true){}
+    qint64 openUsecs;//打开数据库文件
+    qint64 pragmaUsecs;//连接参数设置(包括切换WAL模式)
+    qint64 warmupUsecs;//预处理热点语句
+    qint64 readyUsecs;//createSqliteConnection()的总耗时，即可以执行第一条查询的时间
+    qint64 integrityCheckUsecs;//完整性检测 -1表示未执行或后台尚未完成
+    qint64 prefetchUsecs;//后台预读 -1表示未执行或尚未完成
+    int warmedStatements;//预处理成功的语句数
+    bool isIntegrity;//完整性检测的结果
+};
+
+//内存暂存选项 见enableStaging()
+struct StagingOptions
+{
+    StagingOptions():flushIntervalMsecs(1000),flushRowCount(10000){}
+    int flushIntervalMsecs;//定时刷新到磁盘的间隔，即崩溃时最多丢失多长时间的数据
+    int flushRowCount;//暂存的行数达到该值时，下一次写入前先刷新，即崩溃时最多丢失的行数
+};
+
+//内存暂存统计
+struct StagingStats
+{
+    StagingStats():isEnabled(false),stagedRows(0),msecsSinceFlush(0),flushCount(0),flushedRows(0),
+        maxLossMsecs(0),maxLossRows(0){}
+    bool isEnabled;
+    int stagedRows;//当前暂存在内存中(崩溃时会丢失)的行数
+    qint64 msecsSinceFlush;//距离上一次刷新的时间
+    qint64 flushCount;//刷新次数
+    qint64 flushedRows;//已刷新到磁盘的总行数
+    int maxLossMsecs;//配置的最大丢失时长
+    int maxLossRows;//配置的最大丢失行数
+};
+
+//页缓存统计(sqlite3_db_status)
+struct PageCacheStats
+{
+    PageCacheStats():isValid(false),hits(0),misses(0),writes(0),usedBytes(0){}
+    double hitRatio() const
+    {
+        return (hits+misses) ? double(hits)/double(hits+misses) : 0.0;
+    }
+    bool isValid;//是否获取成功 需要SQLITE_NATIVE_API
+    qint64 hits;//页缓存命中次数
+    qint64 misses;//页缓存未命中次数(需要从文件读取)
+    qint64 writes;//写入文件的脏页数
+    qint64 usedBytes;//页缓存当前占用的内存字节数
+};
+
+/*数据库被其他连接或进程锁定(SQLITE_BUSY)时的重试策略 见DatabaseManager::setBusyRetryPolicy()
+ *第n次重试前等待min(initialDelayMsecs*2^n,maxDelayMsecs)，再随机缩短jitterRatio以内的比例，
+ *避免多个等待者在同一时刻重试；从第一次遇到锁开始超过timeoutMsecs后放弃，语句返回"database is locked"*/
+struct BusyRetryPolicy
+{
+    BusyRetryPolicy(int timeoutMsecs=5000,int initialDelayMsecs=1,int maxDelayMsecs=100,double jitterRatio=0.5)
+        :timeoutMsecs(timeoutMsecs),initialDelayMsecs(initialDelayMsecs),maxDelayMsecs(maxDelayMsecs),
+          jitterRatio(jitterRatio){}
+    int timeoutMsecs;//等待期限 0表示不等待立即失败
+    int initialDelayMsecs;
+    int maxDelayMsecs;
+    double jitterRatio;//0-1
+};
+
+//数据库锁等待统计
+struct BusyStats
+{
+    BusyStats():busyEvents(0),retries(0),timeouts(0),waitMsecs(0){}
+    qint64 busyEvents;//语句遇到数据库被锁的次数(一次等待只计一次)
+    qint64 retries;//重试次数
+    qint64 timeouts;//超过期限放弃的次数
+    qint64 waitMsecs;//等待的总时间
+};
+
+//全文检索的一条结果 见DatabaseManager::search()
+struct FullTextMatch
+{
+    FullTextMatch():rowid(0),rank(0.0){}
+    qint64 rowid;//源表中匹配的行
+    double rank;//bm25相关度 越小越相关
+    QString snippet;//匹配内容的摘要 匹配的词用[]标出
+};
+
+//数据变更通知 见DatabaseManager::enableChangeNotification()
+struct TableChange
+{
+    enum Operation{Insert,Update,Delete};
+    TableChange():operation(Insert),isAllRows(false){}
+    QString tableName;
+    Operation operation;
+    QList<qint64> rowids;//受影响行的rowid
+    bool isAllRows;//行数超过上限或整表变化(删除整表数据、删表)，rowids无效，需要重新加载整个表
+};
+Q_DECLARE_METATYPE(TableChange)
+
 class DatabaseManager : public QObject
 {
+    Q_OBJECT
+    friend class ReadSnapshot;//读快照需要直接操作读连接的事务
 public:
+    enum AccessType{ReadAccess,WriteAccess};//语句的读写类型 用于选择忙等待的重试策略
+
     DatabaseManager(QString connectionName,QObject *parent = 0);
     ~DatabaseManager();
 
-    bool createSqliteConnection(QString databaseName);//创建sqlite连接
+    bool createSqliteConnection(QString databaseName,SqliteConnectionOptions options=SqliteConnectionOptions());//创建sqlite连接
     void closeConnection();//断开连接
     bool integrityCheck();//数据库完整性检测
+    QString databaseName();//当前连接的数据库名
+    bool enableWalMode();//切换为WAL日志模式 读快照(ReadSnapshot)依赖该模式
+    PageCacheStats pageCacheStats(bool reset=false);//页缓存命中/未命中/写入统计
+    StartupStats startupStats();//最近一次createSqliteConnection()各阶段的耗时
+    /*内存暂存 指定表的写入先进入附加的内存数据库，定时或达到行数后批量刷新到磁盘，
+     *查询时合并暂存和磁盘上的数据*/
+    bool enableStaging(QList<QString> tableNames,StagingOptions options=StagingOptions());
+    bool disableStaging();//刷新剩余数据并关闭暂存
+    bool flushStaging();//立即把暂存的数据刷新到磁盘
+    StagingStats stagingStats();
+    /*数据变更通知 在连接上安装sqlite3的update/commit钩子，每次提交后发送tableChanged()信号，
+     *替代定时轮询查询(SQLITE_NATIVE_API)*/
+    bool enableChangeNotification(int maxRowids=1000);//maxRowids:每个表每种操作最多记录的rowid数
+    void disableChangeNotification();
+    void setNativeApiEnabled(bool enabled);//是否使用sqlite3原生接口执行语句(SQLITE_NATIVE_API)
+    /*数据库被其他连接或进程锁定时的等待重试 读写分别使用各自的策略(写操作通常可以等得更久)，
+     *在连接前后调用都可以*/
+    void setBusyRetryPolicy(BusyRetryPolicy readPolicy,BusyRetryPolicy writePolicy);
+    BusyStats busyStats(AccessType access,bool reset=false);
     /*****数据定义*******/
     //建表
     bool createTable(QString tableName,QList<QString> &columnNames,QList<QString> &columnTypes,QString tableConstraint=QString());//建表
@@ -62,11 +218,39 @@ public:
     //复制表
     bool copyTable(QString srcTableName,QString desTableName);//数据库内复制
     bool copyTable(QString srcDbName,QString srcTableName,QString desTableName);//数据库间复制
+    //增量复制 只复制上次复制之后新增(水位列的值更大)的行，源表结构变化时退化为全量复制
+    bool copyTableDelta(QString srcTableName,QString desTableName,QString watermarkColumnName="rowid");
+    bool copyTableDelta(QString srcDbName,QString srcTableName,QString desTableName,QString watermarkColumnName="rowid");
+    //增量同步 用触发器记录表的变更，导出为变更集文件后在另一个数据库中应用(见changeset.h)
+    bool startChangeCapture(QString tableName,QString keyColumnName);
+    bool stopChangeCapture(QString tableName);
+    bool writeChangeset(QString tableName,QString fileName);//导出上次导出之后的变更
+    bool applyChangeset(QString fileName,Changeset::ConflictPolicy policy=Changeset::Abort);
+    /*全文检索(FTS5) 为表的文本列建立全文索引(表名_fts)，由触发器与源表保持同步，
+     *替代like '%...%'的全表扫描*/
+    bool createFullTextIndex(QString tableName,QList<QString> columnNames,QString tokenizer=QString());
+    bool rebuildFullTextIndex(QString tableName);//按源表重建全部索引
+    bool dropFullTextIndex(QString tableName);
+    QList<FullTextMatch> search(QString tableName,QString query,int limit=20);//按相关度排序
+    /*多维范围索引(R*Tree) 为表的1-5个数值列建立R*Tree索引(表名_rtree)，由触发器与源表保持同步，
+     *按多个列的范围同时查询(例如时间x数值x通道)。minValues/maxValues按建立索引的列顺序给出每一维的
+     *上下界(闭区间)，无效的QVariant表示该维不限*/
+    bool createRangeIndex(QString tableName,QList<QString> columnNames,bool isInteger=false);
+    bool rebuildRangeIndex(QString tableName);
+    bool dropRangeIndex(QString tableName);
+    QList<qint64> selectRangeRowids(QString tableName,QVariantList minValues,QVariantList maxValues,int limit=-1);
+    QList<QVariantList> selectRangeRows(QString tableName,QList<QString> columnNames,QVariantList minValues,
+                                        QVariantList maxValues,int limit=-1);//columnNames为空则查询整行
 
     /******数据更新*********/
     //插入数据
     bool insertTable(QString tableName,QVariantList &rowValues,QList<QString> columnNames=QList<QString>());
     bool insertBatchTable(QString tableName, QList<QVariantList> &columnValues, QList<QString> columnNames=QList<QString>());
+    //按结构体映射批量插入 直接从记录中绑定成员，不需要按列转置成QVariantList(见recordmapping.h)
+    template<typename Record>
+    bool insertRecords(QString tableName,const std::vector<Record> &records);
+    template<typename Record>
+    bool insertRecords(QString tableName,const std::vector<Record> &records,const RecordMapping<Record> &mapping);
     bool insertTable(QString insertSql);
     //修改数据
     bool updateTable(QString tableName,QList<QString> &columnNames,QVariantList &rowValues,QString whereSql=QString());
@@ -77,6 +261,8 @@ public:
     //删除数据
     bool deleteTable(QString tableName, QString whereSql=QString());
     bool deleteTable(QString tableName, QString whereColName,QVariant whereColValue);
+    bool deleteBatchTable(QString tableName, QString whereColName,QVariantList whereColValues);//按键值列表批量删除
+    int lastRowsAffected();//当前线程最近一次修改语句影响的行数
 
     /******数据查询**********/
     //查询单行数据记录
@@ -84,14 +270,59 @@ public:
     QVariant selectSingleColData(QString tableName,QString columnName,QString whereColName,QVariant whereColValue);
     QVariantList selectMultiColData(QString tableName,QList<QString> columnNames,QString whereSql);//单行多列
     QVariantList selectMultiColData(QString tableName,QList<QString> columnNames,QString whereColName,QVariant whereColValue);
+    //按键值列表批量查询单行多列 返回键值(字符串形式)到行数据的映射
+    QHash<QString,QVariantList> selectBatchMultiColData(QString tableName,QList<QString> columnNames,QString whereColName,QVariantList whereColValues);
     //查询多行数据记录
     QVariantList selectSingleColDatas(QString tableName,QString columnName,bool isDistinct=true,QString whereSql=QString());//多行单列
     QVariantList selectSingleColDatas(QString tableName,QString columnName,QString whereColName,QVariant whereColValue,bool isDistinct=true);
+    //查询多行多列数据到内存池结果集 减少大量数据查询时的内存分配
+    bool selectResultSet(ArenaResultSet &resultSet,QString tableName,QList<QString> columnNames,QString whereSql=QString());
+    //按游标分页查询 借助orderColumnName上的索引定位，每一页的代价相同(见tablepager.h)
+    bool selectPage(QList<QVariantList> &rows,QVariant &nextKey,QString tableName,QList<QString> columnNames,
+                    QString orderColumnName,QVariant afterKey=QVariant(),int pageSize=100,QString whereSql=QString(),
+                    bool isDescending=false);
     //查询数据表行数
     int selectRowCount(QString tableName,QString whereSql=QString());
     //查询表是否存在
     bool isExistTable(QString tableName);
+    //查询表的列名 按建表时的顺序，表不存在时为空
+    QStringList selectColumnNames(QString tableName);
+
+    /******大数据BLOB流式读写(SQLITE_NATIVE_API)**********/
+    //打开指定行的BLOB字段 返回已打开的设备，由调用者负责析构，失败返回0
+    QIODevice *openBlob(QString tableName,QString columnName,qint64 rowid,QIODevice::OpenMode mode);
+    //将指定行的BLOB字段重置为size字节的0 增量写入前需要预留空间
+    bool resizeBlob(QString tableName,QString columnName,qint64 rowid,qint64 size);
+
+    /******常驻内存的表镜像(读多写少的表)**********/
+    bool pinTable(QString tableName,QString keyColumnName);//加载镜像 按键值列的单行查询直接从内存返回
+    void unpinTable(QString tableName);
+    bool isPinnedTable(QString tableName);
+
+    /******大字段的透明压缩(见columncodec.h)**********/
+    bool setColumnCompression(QString tableName,QString columnName,ColumnCompressionOptions options=ColumnCompressionOptions());
+    void removeColumnCompression(QString tableName,QString columnName);
+    //各压缩列的统计信息 键为"小写表名.小写列名"
+    QHash<QString,ColumnCompressionStats> columnCompressionStats();
 
+    /******编译期表结构(TableSchema,见tableschema.h)使用的接口**********/
+    //执行预先生成好的sql 不拼接语句，写操作对表加写锁，查询加读锁
+    bool execSchemaSql(const QString &tableName,const QString &sql,const QVariantList &bindValues);
+    bool selectSchemaSql(const QString &tableName,const QString &sql,const QVariantList &bindValues,
+                         QVariantList &values,int maxRows=-1);
+
+    //查询各表的锁竞争统计信息(MT_SAFE) 键为小写表名，数据库独占锁为DATABASE_LOCK_NAME
+    QHash<QString,TableLockStats> lockStatistics(bool reset=false);
+
+signals:
+    /*事务提交后在DatabaseManager所在的线程中发送，同一轮事件循环内的多次提交合并为一次，
+     *每个元素为一个表的一种操作*/
+    void tableChanged(QList<TableChange> changes);
+    //后台完整性检测(SqliteConnectionOptions::backgroundIntegrityCheck)结束 在后台线程中发送
+    void integrityChecked(bool isIntegrity);
+
+private slots:
+    void emitTableChanges();
 
 private:
     //附加数据库与分离数据库
@@ -100,12 +331,208 @@ private:
     //复制表 复制数据库表　仅执行insert的sql语句
     bool onlyCopyTable(QString srcTableName,QString desTableName);
     bool isExistTableForCopyTable(QString tableName);//查询表是否存在
+    bool createTableForCopyTable(QString createSql);//建表
+    bool deltaCopyTable(const QString &sourceName,const QString &schemaName,const QString &srcTableName,
+                        const QString &desTableName,const QString &watermarkColumnName);//增量复制 调用者负责加锁
     QString getCreateTableSqlForCopyTable(QString masterTableName,QString tableName);//获取表的创建语句
+    QString getBindValuesStr(int count);//生成count个以逗号分隔的占位符
+    sqlite3 *sqliteHandle();//获取底层的sqlite3连接句柄 不可用时返回0
+    //快速启动的后台任务 在独立的连接上执行
+    void runStartupTasks(const QString &databaseName,bool isIntegrityCheck,const QStringList &prefetchTables);
+    bool prefetchTable(const QString &tableName);
+    QStringList tableColumnNames(const QString &tableName,const QString &schemaName=QString());//按表中的顺序 不加锁
+    bool applyChangesetEntry(const Changeset &changeset,const ChangesetEntry &entry,Changeset::ConflictPolicy policy,
+                             bool &isConflict);
+    //生成范围查询的from/where子句 调用者负责加锁
+    bool rangeQueryClause(const QString &tableName,const QVariantList &minValues,const QVariantList &maxValues,
+                          QString &clauseSql,QVariantList &bindValues);
+    //内存暂存的路由 写入到暂存表，查询合并暂存表和磁盘表，修改前先刷新
+    QString stagingCreateSql(const QString &tableName);
+    bool unstageTable(const QString &tableName);
+    bool isStagedTable(const QString &tableName);
+    QString stagingWriteTable(const QString &tableName);
+    QString stagingReadSource(const QString &tableName);
+    void prepareStagedWrite(const QString &tableName);
+    void prepareStagedModify(const QString &tableName);
+    void addStagedRows(const QString &tableName,int rowCount);
+    //表镜像
+    QSharedPointer<TableMirror> findMirror(const QString &tableName);
+    bool loadMirror(TableMirror *mirror,const QString &tableName);
+    bool selectMirror(const QString &tableName,const QList<QString> &columnNames,const QString &whereColName,
+                      const QVariant &whereColValue,QVariantList &values);
+    void refreshMirror(const QString &tableName,const QString &whereColName=QString(),
+                       const QVariantList &whereColValues=QVariantList(),const QList<QString> &changedColumns=QList<QString>());
+    void refreshMirrorRow(const QString &tableName,const QList<QString> &columnNames,const QVariantList &rowValues);
+    //列压缩 写入前按列压缩，查询结果中的压缩值在execSelect()中统一解压
+    bool hasColumnCompression(const QString &tableName);
+    QVariantList compressValues(const QString &tableName,const QList<QString> &columnNames,const QVariantList &values);
+    QList<QVariantList> compressColumnValues(const QString &tableName,const QList<QString> &columnNames,
+                                             const QList<QVariantList> &columnValues);
+    void decompressValues(QVariantList &values,int from);
+    void shareCodecDictionaries(DatabaseManager *source);
+    //数据变更通知 钩子在执行语句的线程中回调
+    static void updateHookCallback(void *context,int operation,const char *databaseName,const char *tableName,qint64 rowid);
+    static int commitHookCallback(void *context);
+    static void rollbackHookCallback(void *context);
+    void mergeTableChange(QList<TableChange> &changes,const TableChange &change);
+    void notifyTableCleared(const QString &tableName);//删除整表数据、删表不会触发update钩子
+    //忙等待 原生接口可用时安装忙处理器，否则只能设置统一的busy_timeout(写策略的期限)
+    static int busyHandlerCallback(void *context,int count);
+    static int progressHandlerCallback(void *context);//操作期限(OperationDeadline)的检查
+    void installBusyHandler();
+    //语句执行 原生接口可用时使用缓存的sqlite3_stmt，否则使用QSqlQuery，均不加锁
+    bool isNativeApiAvailable();
+    //事务 开启成功后持有transactionMutex，直到提交或回滚
+    bool beginTransaction(const char *errorTag);
+    bool commitTransaction(const char *errorTag);
+    void rollbackTransaction();
+    bool execSql(const QString &sql,const QVariantList &bindValues,const char *errorTag);
+    bool execBatchSql(const QString &sql,const QList<QVariantList> &columnValues,const char *errorTag);
+    bool execSelect(const QString &sql,const QVariantList &bindValues,QVariantList &values,
+                    int *columnCount,int maxRows,const char *errorTag);
 
     QSqlDatabase db;//描述数据库连接的对象 全局共用一个数据库连接
     QString connectionName;//连接名，通过连接名可以在全局找到对应的数据库
-    //读写锁 在构造函数内显式或隐式初始化,目前只在多线程安全条件下会用到
-    QReadWriteLock readWriteLock;
+    //表锁管理器 每个表一个读写锁,目前只在多线程安全条件下会用到
+    TableLockManager lockManager;
+    /*事务互斥 所有线程共用一个连接，一个线程的事务期间其他线程的语句会成为该事务的一部分，
+     *表锁只保护各自的表，所以开启事务到提交/回滚之间、以及每条写语句都持有该锁(可重入)*/
+    QMutex transactionMutex;
+    bool isWalMode;//是否已切换为WAL模式
+    //快速启动
+    QFuture<void> startupFuture;//后台任务 关闭连接前等待结束
+    QMutex startupMutex;//保护启动耗时统计 后台任务结束时写入
+    StartupStats startupTimings;
+    bool nativeApiEnabled;//是否使用sqlite3原生接口
+    int nativeHandleState;//驱动的sqlite3句柄能否用于本程序链接的库 -1:未检查 0:不能 1:能
+    //内存暂存 表名列表只在enableStaging()/disableStaging()中修改，读写都在stagingMutex保护下
+    QStringList stagedTables;
+    StagingOptions stagingOptions;
+    QAtomicInt stagedTableCount;//暂存的表数 为0时不加锁直接跳过
+    QTimer *stagingTimer;//定时触发刷新
+    QFuture<void> stagingFlushFuture;//线程池中正在执行的刷新
+    QAtomicInt stagedRowCount;//当前暂存的行数
+    QMutex stagingMutex;//保护表名列表、选项和下面的统计数据
+    QElapsedTimer lastFlushTime;
+    qint64 stagingFlushCount;
+    qint64 stagingFlushedRows;
+    //表镜像 小写表名->镜像
+    QHash<QString,QSharedPointer<TableMirror> > mirrors;
+    QReadWriteLock mirrorLock;//保护镜像的映射表
+    QAtomicInt mirrorCount;//镜像数量 为0时查询和写操作跳过镜像处理
+    //列压缩 小写表名->(表的全部列名,小写列名->编解码器)
+    struct TableCodecs
+    {
+        QStringList columnNames;//插入整个元组时按位置确定列
+        QHash<QString,QSharedPointer<ColumnCodec> > codecs;
+    };
+    QHash<QString,TableCodecs> columnCodecs;
+    QHash<quint32,QByteArray> codecDictionaries;//字典标识->预置字典 解压时使用
+    QReadWriteLock codecLock;//保护上面两个映射表
+    QAtomicInt codecCount;//压缩列数量 为0时写操作跳过压缩处理
+    QAtomicInt isDecompressEnabled;//配置过压缩列 之后的查询都检查压缩值(关闭压缩后已压缩的值仍需解压)
+    //忙等待
+    QMutex busyMutex;//保护下面的策略和统计
+    BusyRetryPolicy readBusyPolicy;
+    BusyRetryPolicy writeBusyPolicy;
+    BusyStats readBusyStats;
+    BusyStats writeBusyStats;
+    //数据变更通知
+    bool isChangeNotificationEnabled;
+    int maxChangeRowids;
+    QMutex changeMutex;//保护下面的变更列表
+    QList<TableChange> uncommittedChanges;//当前事务中的变更 回滚时丢弃
+    QList<TableChange> committedChanges;//已提交等待发送的变更
+    bool isChangeEmitPending;//是否已投递发送信号的事件
+#ifdef SQLITE_NATIVE_API
+    SqliteStatementCache statementCache;//按sql缓存的预处理语句
+#endif
 };
 
+/*
+ *@brief:  按结构体的默认映射(recordMapping<Record>())批量插入多条记录
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   records:连续存放的记录
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+template<typename Record>
+bool DatabaseManager::insertRecords(QString tableName, const std::vector<Record> &records)
+{
+    return insertRecords(tableName,records,recordMapping<Record>());
+}
+/*
+ *@brief:  按结构体映射批量插入多条记录 所有记录在一个事务内插入。
+ *  原生接口可用时同一条预处理语句逐条记录重新绑定执行，成员值直接从records中读取，
+ *  不产生QVariant；否则按列转置后通过QSqlQuery批处理。
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   records:连续存放的记录
+ *@param:   mapping:成员与列名的映射
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+template<typename Record>
+bool DatabaseManager::insertRecords(QString tableName, const std::vector<Record> &records, const RecordMapping<Record> &mapping)
+{
+    if(records.empty())
+    {
+        return true;
+    }
+    int columnCount = mapping.columnCount();
+    if(!columnCount)
+    {
+        qDebug()<<"record mapping has no column...";
+        return false;
+    }
+    QString insertSql = QString("insert into %1(%2) values(%3);")
+            .arg(stagingWriteTable(tableName),mapping.columnNames().join(","),getBindValuesStr(columnCount));
+    prepareStagedWrite(tableName);
+#ifdef MT_SAFE
+    TableLocker locker(&lockManager,tableName,TableLocker::WriteLock);//写锁
+#endif
+    if(!beginTransaction("insert records transaction error:"))
+    {
+        return false;
+    }
+    bool isSuccess;
+#ifdef SQLITE_NATIVE_API
+    //有压缩列时需要先得到各列的QVariant，走下面的批处理
+    if(isNativeApiAvailable() && !hasColumnCompression(tableName))
+    {
+        SqliteStatement statement(&statementCache,insertSql);
+        isSuccess = statement.isValid();
+        for(size_t row=0;isSuccess && row<records.size();row++)
+        {
+            isSuccess = mapping.bind(statement,records[row]) && statement.exec();
+        }
+        if(!isSuccess)
+        {
+            qDebug()<<"insert records error:"<<statement.lastError();
+            qDebug()<<"error sql:"<<insertSql;
+        }
+    }
+    else
+#endif
+    {
+        QList<QVariantList> columnValues = mapping.toColumnValues(records);
+        if(hasColumnCompression(tableName))
+        {
+            columnValues = compressColumnValues(tableName,mapping.columnNames(),columnValues);
+        }
+        isSuccess = execBatchSql(insertSql,columnValues,"insert records error:");
+    }
+    if(!isSuccess)
+    {
+        rollbackTransaction();//批量插入失败，回滚到之前的状态
+        return false;
+    }
+    if(!commitTransaction("insert records transaction error:"))//提交事务 失败时已回滚
+    {
+        return false;
+    }
+    addStagedRows(tableName,int(records.size()));
+    refreshMirror(tableName);
+    return true;
+}
+
 #endif // DATABASEMANAGER_H
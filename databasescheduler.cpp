@@ -0,0 +1,200 @@
+/*
+ *@file:   databasescheduler.cpp
+ *@date:   2026.10.19
+ *@brief:  按优先级调度数据库操作
+ */
+#include "databasescheduler.h"
+#include <QMutexLocker>
+
+//默认老化时间 排队超过该时间的操作按最高优先级调度
+#define DEFAULT_AGING_MSECS 2000
+
+DatabaseScheduler::DatabaseScheduler(DatabaseManager *databaseManager, int bulkChunkRows)
+    :manager(databaseManager),chunkRows(qMax(1,bulkChunkRows)),agingMsecs(DEFAULT_AGING_MSECS),
+      runningReaders(0),isWriterRunning(false)
+{
+    for(int i=0;i<PriorityCount;i++)
+    {
+        nextTicket[i] = 0;
+        servingTicket[i] = 0;
+    }
+    clock.start();
+}
+
+DatabaseManager *DatabaseScheduler::databaseManager()
+{
+    return manager;
+}
+
+void DatabaseScheduler::setBulkChunkRows(int rows)
+{
+    QMutexLocker locker(&mutex);
+    chunkRows = qMax(1,rows);
+}
+
+void DatabaseScheduler::setAgingMsecs(int msecs)
+{
+    QMutexLocker locker(&mutex);
+    agingMsecs = msecs;
+    condition.wakeAll();
+}
+/*
+ *@brief:   按优先级执行一个操作 读操作可以同时执行，写操作独占执行。先开始优先级最高的
+ * 等待者，同一优先级按排队的先后顺序；排队超过老化时间的操作优先于未老化的操作
+ *@date:    2026.10.19
+ *@param:   priority:优先级
+ *@param:   operation:要执行的操作 参数为DatabaseManager，返回值作为run()的返回值
+ *@param:   type:Read只读 Write写(默认)
+ *@return:  返回值为布尔类型，操作的返回值
+ */
+bool DatabaseScheduler::run(Priority priority, const std::function<bool(DatabaseManager *)> &operation, OperationType type)
+{
+    QThread *thread = QThread::currentThread();
+    QMutexLocker locker(&mutex);
+    //操作内部再次调用调度器时直接执行，否则会等待自己结束而锁死
+    if(activeThreads.contains(thread))
+    {
+        locker.unlock();
+        return operation(manager);
+    }
+    SchedulerStats &stats = priorityStats[priority];
+    qint64 enqueueMsecs = clock.elapsed();
+    quint64 ticket = nextTicket[priority]++;
+    waitingSince[priority].enqueue(enqueueMsecs);
+    stats.queueDepth++;
+    while(!canStart(priority,ticket,type))
+    {
+        condition.wait(&mutex);
+    }
+    if(isAgedHead(priority) && priority != Interactive)
+    {
+        stats.agedStarts++;
+    }
+    waitingSince[priority].dequeue();
+    stats.queueDepth--;
+    servingTicket[priority]++;
+    if(type == Write)
+    {
+        isWriterRunning = true;
+    }
+    else
+    {
+        runningReaders++;
+        condition.wakeAll();//之后的读操作可以同时开始
+    }
+    activeThreads.insert(thread);
+    qint64 waitMsecs = clock.elapsed()-enqueueMsecs;
+    stats.executed++;
+    stats.totalWaitMsecs += waitMsecs;
+    stats.maxWaitMsecs = qMax(stats.maxWaitMsecs,waitMsecs);
+    locker.unlock();
+
+    bool isSuccess = operation(manager);
+
+    locker.relock();
+    activeThreads.remove(thread);
+    if(type == Write)
+    {
+        isWriterRunning = false;
+    }
+    else
+    {
+        runningReaders--;
+    }
+    condition.wakeAll();
+    return isSuccess;
+}
+/*
+ *@brief:   批量插入 按每批行数拆分，每个批次作为一个操作单独排队(各自一个事务)，
+ * 批次之间让更高优先级的操作先执行
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnValues:按列存放的数据 同DatabaseManager::insertBatchTable()
+ *@param:   columnNames:对应的列名 为空表示整个元组
+ *@param:   priority:优先级
+ *@return:  返回值为布尔类型，true:成功，false:某个批次失败(之前的批次已写入)
+ */
+bool DatabaseScheduler::insertBatchTable(QString tableName, const QList<QVariantList> &columnValues,
+                                         QList<QString> columnNames, Priority priority)
+{
+    int rowCount = columnValues.isEmpty() ? 0 : columnValues.first().size();
+    int rows;
+    {
+        QMutexLocker locker(&mutex);
+        rows = chunkRows;
+    }
+    for(int start=0;start<rowCount;start+=rows)
+    {
+        QList<QVariantList> chunkValues;
+        for(int i=0;i<columnValues.size();i++)
+        {
+            chunkValues.append(columnValues.at(i).mid(start,rows));
+        }
+        bool isSuccess = run(priority,[&](DatabaseManager *databaseManager){
+            return databaseManager->insertBatchTable(tableName,chunkValues,columnNames);
+        });
+        if(!isSuccess)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   获取某个优先级的调度统计
+ *@date:    2026.10.19
+ *@param:   priority:优先级
+ *@param:   reset:获取后是否清零累计的统计(不影响当前排队数)
+ *@return:  SchedulerStats:排队数、执行数及等待时间
+ */
+SchedulerStats DatabaseScheduler::stats(Priority priority, bool reset)
+{
+    QMutexLocker locker(&mutex);
+    SchedulerStats result = priorityStats[priority];
+    if(reset)
+    {
+        SchedulerStats &stats = priorityStats[priority];
+        stats.executed = 0;
+        stats.totalWaitMsecs = 0;
+        stats.maxWaitMsecs = 0;
+    }
+    return result;
+}
+/*调用者持有mutex 轮到该号、没有排在前面的其他优先级的等待者，且没有冲突的操作正在执行
+ *(写操作要求空闲，读操作要求没有写操作)时可以开始*/
+bool DatabaseScheduler::canStart(int priority, quint64 ticket, OperationType type)
+{
+    if(servingTicket[priority] != ticket)
+    {
+        return false;
+    }
+    if(isWriterRunning || (type == Write && runningReaders > 0))
+    {
+        return false;
+    }
+    int rank = queueRank(priority);
+    for(int i=0;i<PriorityCount;i++)
+    {
+        if(i == priority || waitingSince[i].isEmpty())
+        {
+            continue;
+        }
+        int otherRank = queueRank(i);
+        if(otherRank < rank || (otherRank == rank && i < priority))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+//调用者持有mutex 该优先级排在最前面的操作是否已超过老化时间
+bool DatabaseScheduler::isAgedHead(int priority)
+{
+    return agingMsecs > 0 && !waitingSince[priority].isEmpty() &&
+            clock.elapsed()-waitingSince[priority].head() >= agingMsecs;
+}
+//调用者持有mutex 调度的先后 老化的队列排在所有未老化的队列之前
+int DatabaseScheduler::queueRank(int priority)
+{
+    return isAgedHead(priority) ? -1 : priority;
+}
@@ -0,0 +1,106 @@
+/*
+ *@file:   databasescheduler.h
+ *@date:   2026.10.19
+ *@brief:  按优先级调度数据库操作
+ * 后台线程连续调用insertBatchTable()时，每次都长时间持有表的写锁，界面线程的查询只能排在
+ * 后面，而QReadWriteLock不能指定优先级。DatabaseScheduler放在DatabaseManager前面，通过它
+ * 执行的读操作可以同时运行，写操作独占执行(与所有读写操作互斥)，等待的操作按优先级(交互、
+ * 普通、批量)、同一优先级按先后顺序开始执行。批量写入拆分成多个小批次，每个批次单独排队，
+ * 批次之间有更高优先级的操作在等待时先执行它们，所以交互操作最多等待一个正在执行的写操作
+ * (一个批次)。低优先级的操作排队超过老化时间(默认2秒)后按最高优先级调度，持续的交互操作
+ * 不会让批量操作无限期地等待。
+ *
+ * 用法:
+ *   DatabaseScheduler scheduler(databaseManager);
+ *   scheduler.insertBatchTable("aa",columnValues);//后台线程 默认按批量优先级拆分执行
+ *   QVariantList row;
+ *   scheduler.run(DatabaseScheduler::Interactive,[&](DatabaseManager *manager){//界面线程
+ *       row = manager->selectMultiColData("aa",QList<QString>(),"id",100);
+ *       return !row.isEmpty();
+ *   },DatabaseScheduler::Read);//只读操作之间不互斥
+ *   SchedulerStats stats = scheduler.stats(DatabaseScheduler::Interactive);//排队数和等待时间
+ *
+ * 注:1.只有通过调度器执行的操作之间有优先级，直接调用DatabaseManager的操作不参与排队。
+ *    2.拆分后的批量插入每个批次一个事务，中途失败时之前的批次已经写入。
+ *    3.操作内部再调用同一个调度器时直接执行，不会重新排队。
+ *    4.run()默认按写操作独占执行，只有确定操作中没有任何修改时才能标记为Read，
+ *      Read操作之间的并发由DatabaseManager的表读锁保证安全。
+ */
+#ifndef DATABASESCHEDULER_H
+#define DATABASESCHEDULER_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QQueue>
+#include <QSet>
+#include <QThread>
+#include <functional>
+#include "databasemanager.h"
+
+//单个优先级的调度统计
+struct SchedulerStats
+{
+    SchedulerStats():queueDepth(0),executed(0),totalWaitMsecs(0),maxWaitMsecs(0),agedStarts(0){}
+    double avgWaitMsecs() const
+    {
+        return executed ? double(totalWaitMsecs)/double(executed) : 0.0;
+    }
+    int queueDepth;//当前排队等待的操作数
+    qint64 executed;//已开始执行的操作数
+    qint64 totalWaitMsecs;//排队等待的累计时间
+    qint64 maxWaitMsecs;//最长的一次等待
+    qint64 agedStarts;//排队超过老化时间后提前执行的次数
+};
+
+class DatabaseScheduler
+{
+public:
+    enum Priority
+    {
+        Interactive,//界面响应相关的操作
+        Normal,
+        Bulk,//批量导入等可以被打断的操作
+        PriorityCount
+    };
+    enum OperationType
+    {
+        Read,//只读 可以与其他读操作同时执行
+        Write//独占执行
+    };
+    explicit DatabaseScheduler(DatabaseManager *databaseManager,int bulkChunkRows=1000);
+
+    DatabaseManager *databaseManager();
+    void setBulkChunkRows(int rows);//批量写入拆分的每批行数
+    void setAgingMsecs(int msecs);//排队超过该时间的操作按最高优先级调度 <=0表示不老化
+
+    //在调用线程中按优先级执行一个操作 排队直到轮到该操作，返回操作的返回值
+    bool run(Priority priority,const std::function<bool(DatabaseManager *)> &operation,OperationType type=Write);
+    //批量插入 按每批行数拆分，每个批次单独排队
+    bool insertBatchTable(QString tableName,const QList<QVariantList> &columnValues,
+                          QList<QString> columnNames=QList<QString>(),Priority priority=Bulk);
+
+    SchedulerStats stats(Priority priority,bool reset=false);
+
+private:
+    bool canStart(int priority,quint64 ticket,OperationType type);
+    bool isAgedHead(int priority);
+    int queueRank(int priority);
+
+    DatabaseManager *manager;
+    int chunkRows;
+    int agingMsecs;
+    QElapsedTimer clock;//排队时刻的时钟
+    QMutex mutex;//保护下面的排队状态和统计
+    QWaitCondition condition;
+    int runningReaders;//正在执行的读操作数
+    bool isWriterRunning;//是否有写操作正在执行
+    QSet<QThread *> activeThreads;//正在执行操作的线程 用于识别嵌套调用
+    //每个优先级按取号顺序执行 nextTicket为下一个取的号，servingTicket为下一个执行的号
+    quint64 nextTicket[PriorityCount];
+    quint64 servingTicket[PriorityCount];
+    QQueue<qint64> waitingSince[PriorityCount];//各优先级排队中的操作开始排队的时刻 按取号顺序
+    SchedulerStats priorityStats[PriorityCount];
+};
+
+#endif // DATABASESCHEDULER_H
@@ -2,7 +2,9 @@
 #define GLOBALVAR_H
 #include <QMutex>
 #include "databasemanager.h"
+#include "databasescheduler.h"
 extern DatabaseManager *databaseManager;
+extern DatabaseScheduler *databaseScheduler;//按优先级调度后台线程和界面的数据库操作
 //extern int number;//声明全局变量，这里是为了让多个不同线程操作全局变量，测试互斥锁的作用
 /*线程使用的互斥锁，不同的线程要想使用互斥锁，必须公用同一个mutex。
 因为本例的两个线程是继承只QThread，在两个类中，所以需要定义一个全局的互斥锁变量*/
@@ -24,30 +24,47 @@ void MyThread::stop()//公有方法操作私有变量
     stopped = true;
 }
 
+//插入的记录 通过recordMapping()映射到表的各个字段
+struct StudentRecord
+{
+    int id;
+    QString name;
+    int score;
+    int age;
+};
+template<>
+const RecordMapping<StudentRecord> &recordMapping<StudentRecord>()
+{
+    static const RecordMapping<StudentRecord> mapping = RecordMapping<StudentRecord>()
+            .column("id",&StudentRecord::id).column("name",&StudentRecord::name)
+            .column("score",&StudentRecord::score).column("age",&StudentRecord::age);
+    return mapping;
+}
+
 //线程启动后进入该函数，该函数退出则线程退出
 void MyThread::run()
 {
     while(!stopped)
     {
         QString tableName = "aa";
-        QVariantList idList;
-        QVariantList nameList;
-        QVariantList scoreList;
-        QVariantList ageList;
-        QList<QVariantList> list;
+        std::vector<StudentRecord> records;
         QStringList name;
         name<<"a"<<"b"<<"c"<<"d"<<"e"<<"f"<<"g"<<"h"<<"i"<<"j"<<"k"<<"l"<<"m"<<"n";
         int nameNum = name.size();
+        records.reserve(100);
         for(int i =0;i<100;i++)
         {
-            idList<<i;
-            nameList<<name.at(i%nameNum);
-            scoreList<<qrand()%10+85;
-            ageList<<qrand()%5+16;
+            StudentRecord record;
+            record.id = i;
+            record.name = name.at(i%nameNum);
+            record.score = qrand()%10+85;
+            record.age = qrand()%5+16;
+            records.push_back(record);
         }
-        list<<idList<<nameList<<scoreList<<ageList;
         qDebug()<<"thread1 start:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
-        if(databaseManager->insertBatchTable(tableName,list))
+        //按结构体直接插入，不需要按列转置成QVariantList 以批量优先级排队，不阻塞界面的查询
+        if(databaseScheduler->run(DatabaseScheduler::Bulk,[&](DatabaseManager *manager){
+                                  return manager->insertRecords(tableName,records);}))
         {
             qDebug()<<"insert  batch table success;";
         }
@@ -0,0 +1,76 @@
+/*
+ *@file:   operationdeadline.cpp
+ *@date:   2026.10.19
+ *@brief:  数据库操作的期限及取消
+ */
+#include "operationdeadline.h"
+#include <QDebug>
+
+/*当前线程最内层的期限 每个线程各自一个链表，由构造/析构维护。
+ *期限对象在栈上，不能用QThreadStorage(设置新值时会delete旧值)*/
+static thread_local OperationDeadline *currentDeadline = 0;
+//所有线程中存在的期限数 为0时回调直接返回，不访问线程存储
+static QAtomicInt activeDeadlineCount(0);
+
+OperationDeadline::OperationDeadline(int timeoutMsecs)
+    :timeoutMsecs(timeoutMsecs),isCanceled(0),interrupted(0)
+{
+    timer.start();
+    previous = currentDeadline;
+    currentDeadline = this;
+    activeDeadlineCount.ref();
+}
+
+OperationDeadline::~OperationDeadline()
+{
+    currentDeadline = previous;
+    activeDeadlineCount.deref();
+}
+
+void OperationDeadline::cancel()
+{
+    isCanceled.storeRelease(1);
+}
+
+bool OperationDeadline::isExpired() const
+{
+    return isCanceled.loadAcquire() || (timeoutMsecs >= 0 && timer.elapsed() >= timeoutMsecs);
+}
+
+bool OperationDeadline::isInterrupted() const
+{
+    return interrupted.loadAcquire();
+}
+
+qint64 OperationDeadline::remainingMsecs() const
+{
+    if(timeoutMsecs < 0)
+    {
+        return -1;
+    }
+    return qMax(qint64(0),timeoutMsecs-timer.elapsed());
+}
+/*
+ *@brief:   检查当前线程的期限 由sqlite的进度回调和忙处理器在执行语句的线程中调用
+ *@date:    2026.10.19
+ *@return:  bool:true=任一层期限已到，应中断语句
+ */
+bool OperationDeadline::checkCurrent()
+{
+    if(!activeDeadlineCount.loadAcquire())
+    {
+        return false;
+    }
+    for(OperationDeadline *deadline = currentDeadline;deadline;deadline = deadline->previous)
+    {
+        if(deadline->isExpired())
+        {
+            if(!deadline->interrupted.fetchAndStoreOrdered(1))
+            {
+                qDebug()<<"operation interrupted:"<<(deadline->isCanceled.loadAcquire() ? "canceled" : "deadline exceeded");
+            }
+            return true;
+        }
+    }
+    return false;
+}
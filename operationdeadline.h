@@ -0,0 +1,54 @@
+/*
+ *@file:   operationdeadline.h
+ *@date:   2026.10.19
+ *@brief:  数据库操作的期限及取消
+ * 传给selectSingleColDatas()等接口的whereSql写得不好时，可能持有读锁扫描整个表好几秒，
+ * 期间没有办法停止。OperationDeadline在作用域内为当前线程的数据库调用设置期限，
+ * DatabaseManager在连接上安装的sqlite3_progress_handler每执行一定数量的虚拟机指令检查一次，
+ * 超过期限或被取消时中断正在执行的语句，语句以SQLITE_INTERRUPT失败返回，调用按正常的
+ * 失败路径释放表锁、回滚事务。isInterrupted()用于区分是被中断还是其他错误。
+ *
+ * 用法:
+ *   OperationDeadline deadline(200);//本作用域内的调用最多执行200ms
+ *   QVariantList ids = databaseManager->selectSingleColDatas("aa","id",false,whereSql);
+ *   if(deadline.isInterrupted())
+ *   {
+ *       qDebug()<<"query timeout";
+ *   }
+ * 其他线程可以调用deadline.cancel()立即取消(用户点击取消按钮等)。
+ *
+ * 注:1.需要SQLITE_NATIVE_API(sqlite3_progress_handler)，不可用时期限不起作用。
+ *    2.只对创建它的线程有效，ShardedDatabaseManager等在线程池中执行的操作不受影响。
+ *    3.只限制语句执行和等待数据库文件锁(忙等待)的时间，不包括等待TableLockManager表锁的时间。
+ *    4.作用域可以嵌套，任一层超时或取消都会中断。
+ */
+#ifndef OPERATIONDEADLINE_H
+#define OPERATIONDEADLINE_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+class OperationDeadline
+{
+public:
+    explicit OperationDeadline(int timeoutMsecs = -1);//-1表示不限时，只能通过cancel()取消
+    ~OperationDeadline();
+
+    void cancel();//取消 可以在其他线程中调用
+    bool isExpired() const;//是否已超过期限或被取消
+    bool isInterrupted() const;//是否有语句因此被中断
+    qint64 remainingMsecs() const;//剩余时间 不限时为-1
+
+    //当前线程的期限是否已到(任一层) 到期时标记为已中断，供DatabaseManager的回调使用
+    static bool checkCurrent();
+
+private:
+    Q_DISABLE_COPY(OperationDeadline)
+    int timeoutMsecs;
+    QElapsedTimer timer;
+    QAtomicInt isCanceled;
+    QAtomicInt interrupted;
+    OperationDeadline *previous;//外层的期限
+};
+
+#endif // OPERATIONDEADLINE_H
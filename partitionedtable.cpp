@@ -0,0 +1,344 @@
+/*
+ *@file:   partitionedtable.cpp
+ *@date:   2026.10.19
+ *@brief:  按时间分区的表
+ */
+#include "partitionedtable.h"
+#include <QMap>
+#include <QMutexLocker>
+
+/*
+ *@brief:   构造分区表 不会访问数据库，分区表在第一次写入时创建
+ *@date:    2026.10.19
+ *@param:   databaseManager:数据库管理对象
+ *@param:   tableName:逻辑表名
+ *@param:   timeColumnName:时间列名，值为UTC秒数
+ *@param:   granularity:分区粒度
+ */
+PartitionedTable::PartitionedTable(DatabaseManager *databaseManager, QString tableName, QString timeColumnName,
+                                   Granularity granularity)
+    :databaseManager(databaseManager),tableName(tableName),timeColumnName(timeColumnName),
+      granularity(granularity),timeColumnIndex(-1)
+{
+}
+/*
+ *@brief:   设置分区表的表结构
+ *@date:    2026.10.19
+ *@param:   columnNames:列名 必须包含时间列
+ *@param:   columnTypes:列类型
+ *@param:   tableConstraint:表约束
+ */
+void PartitionedTable::setSchema(QList<QString> columnNames, QList<QString> columnTypes, QString tableConstraint)
+{
+    this->columnNames = columnNames;
+    this->columnTypes = columnTypes;
+    this->tableConstraint = tableConstraint;
+    timeColumnIndex = columnNames.indexOf(timeColumnName);
+    if(timeColumnIndex < 0)
+    {
+        qDebug()<<"partitioned table schema has no time column:"<<tableName<<timeColumnName;
+    }
+}
+/*
+ *@brief:   获取时间所在分区的表名
+ *@date:    2026.10.19
+ *@param:   time:UTC秒数
+ *@return:  QString:分区表名 例如aa_p20261019(每天)、aa_p2026101908(每小时)
+ */
+QString PartitionedTable::partitionName(qint64 time)
+{
+    QDateTime dateTime = QDateTime::fromMSecsSinceEpoch(partitionStart(time)*1000,Qt::UTC);
+    QString suffix = dateTime.toString(granularity == Hourly ? "yyyyMMddhh" : "yyyyMMdd");
+    return QString("%1_p%2").arg(tableName,suffix);
+}
+/*
+ *@brief:   查询已存在的分区表
+ *@date:    2026.10.19
+ *@return:  QStringList:分区表名 按时间升序
+ */
+QStringList PartitionedTable::partitions()
+{
+    //'_'在like中是通配符，需要转义
+    QString whereSql = QString("type='table' and name like '%1\\_p%' escape '\\'").arg(tableName);
+    QVariantList names = databaseManager->selectSingleColDatas("sqlite_master","name",false,whereSql);
+    QMap<qint64,QString> partitionMap;//分区起始时间->分区表名
+    for(int i=0;i<names.size();i++)
+    {
+        QString name = names.at(i).toString();
+        qint64 start = partitionStartOf(name);
+        if(start >= 0)
+        {
+            partitionMap.insert(start,name);
+        }
+    }
+    return partitionMap.values();
+}
+/*
+ *@brief:   插入单条数据 按时间列的值写入对应的分区表
+ *@date:    2026.10.19
+ *@param:   rowValues:完整的元组数据，顺序与setSchema()的列名一致
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool PartitionedTable::insert(QVariantList &rowValues)
+{
+    if(timeColumnIndex < 0 || rowValues.size() != columnNames.size())
+    {
+        qDebug()<<"partitioned table insert error: values don't match the schema..."<<tableName;
+        return false;
+    }
+    QString partition = partitionName(rowValues.at(timeColumnIndex).toLongLong());
+    if(!ensurePartition(partition))
+    {
+        return false;
+    }
+    return databaseManager->insertTable(partition,rowValues);
+}
+/*
+ *@brief:   批量插入多条数据 先按分区分组，再对每个分区分别批量插入(事务)
+ * 注:不同分区的插入是相互独立的事务，某个分区失败时，之前分区插入的数据不会回滚
+ *@date:    2026.10.19
+ *@param:   columnValues:按列组织的完整元组数据，同DatabaseManager::insertBatchTable()
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool PartitionedTable::insertBatch(QList<QVariantList> &columnValues)
+{
+    int columnCount = columnValues.size();
+    if(timeColumnIndex < 0 || columnCount != columnNames.size())
+    {
+        qDebug()<<"partitioned table insert error: values don't match the schema..."<<tableName;
+        return false;
+    }
+    const QVariantList &timeValues = columnValues.at(timeColumnIndex);
+    int rowCount = timeValues.size();
+    QMap<QString,QList<QVariantList> > partitionValues;//分区表名->该分区按列组织的数据
+    for(int row=0;row<rowCount;row++)
+    {
+        QList<QVariantList> &values = partitionValues[partitionName(timeValues.at(row).toLongLong())];
+        if(values.isEmpty())
+        {
+            for(int i=0;i<columnCount;i++)
+            {
+                values.append(QVariantList());
+            }
+        }
+        for(int i=0;i<columnCount;i++)
+        {
+            values[i].append(columnValues.at(i).at(row));
+        }
+    }
+    QMap<QString,QList<QVariantList> >::iterator it;
+    for(it=partitionValues.begin();it!=partitionValues.end();++it)
+    {
+        if(!ensurePartition(it.key()) || !databaseManager->insertBatchTable(it.key(),it.value(),columnNames))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+/*
+ *@brief:   查询时间范围内的多行多列数据 各分区按时间列排序后依次合并
+ *@date:    2026.10.19
+ *@param:   columnNames:查询的列名 为空则查询整行数据
+ *@param:   startTime:起始时间(包含)
+ *@param:   endTime:结束时间(不包含)
+ *@param:   whereSql:附加条件(不能包含order by等子句) 为空表示只按时间过滤
+ *@return:  QList<QVariantList>:每个元素为一行数据，失败返回空的列表
+ */
+QList<QVariantList> PartitionedTable::selectRows(QList<QString> columnNames, qint64 startTime, qint64 endTime, QString whereSql)
+{
+    QList<QVariantList> rows;
+    QStringList partitionList = partitionsInRange(startTime,endTime);
+    QString selectWhereSql = rangeWhereSql(startTime,endTime,whereSql)+QString(" order by %1").arg(timeColumnName);
+    ArenaResultSet resultSet;//各分区复用同一个结果集的内存
+    for(int i=0;i<partitionList.size();i++)
+    {
+        if(!databaseManager->selectResultSet(resultSet,partitionList.at(i),columnNames,selectWhereSql))
+        {
+            return QList<QVariantList>();
+        }
+        int rowCount = resultSet.rowCount();
+        int columnCount = resultSet.columnCount();
+        for(int row=0;row<rowCount;row++)
+        {
+            QVariantList rowValues;
+            rowValues.reserve(columnCount);
+            for(int column=0;column<columnCount;column++)
+            {
+                rowValues.append(resultSet.value(row,column));
+            }
+            rows.append(rowValues);
+        }
+    }
+    return rows;
+}
+/*
+ *@brief:   查询时间范围内的多行单列数据 按时间顺序返回
+ *@date:    2026.10.19
+ *@param:   columnName:列名
+ *@param:   startTime:起始时间(包含)
+ *@param:   endTime:结束时间(不包含)
+ *@param:   whereSql:附加条件(不能包含order by等子句)
+ *@return:  QVariantList:列数据
+ */
+QVariantList PartitionedTable::selectSingleColDatas(QString columnName, qint64 startTime, qint64 endTime, QString whereSql)
+{
+    QVariantList values;
+    QStringList partitionList = partitionsInRange(startTime,endTime);
+    QString selectWhereSql = rangeWhereSql(startTime,endTime,whereSql)+QString(" order by %1").arg(timeColumnName);
+    for(int i=0;i<partitionList.size();i++)
+    {
+        values.append(databaseManager->selectSingleColDatas(partitionList.at(i),columnName,false,selectWhereSql));
+    }
+    return values;
+}
+/*
+ *@brief:   查询时间范围内的行数 各分区的行数求和
+ *@date:    2026.10.19
+ *@return:  int:行数 失败返回-1
+ */
+int PartitionedTable::selectRowCount(qint64 startTime, qint64 endTime, QString whereSql)
+{
+    int rowCount = 0;
+    QStringList partitionList = partitionsInRange(startTime,endTime);
+    QString selectWhereSql = rangeWhereSql(startTime,endTime,whereSql);
+    for(int i=0;i<partitionList.size();i++)
+    {
+        int count = databaseManager->selectRowCount(partitionList.at(i),selectWhereSql);
+        if(count < 0)
+        {
+            return -1;
+        }
+        rowCount += count;
+    }
+    return rowCount;
+}
+/*
+ *@brief:   删除过期的分区 分区的结束时间不晚于time时整个分区表被删除
+ *@date:    2026.10.19
+ *@param:   time:UTC秒数
+ *@return:  int:删除的分区数 失败返回-1
+ */
+int PartitionedTable::dropPartitionsBefore(qint64 time)
+{
+    int dropCount = 0;
+    QStringList partitionList = partitions();
+    for(int i=0;i<partitionList.size();i++)
+    {
+        const QString &partition = partitionList.at(i);
+        if(partitionStartOf(partition)+partitionSpan() > time)
+        {
+            break;//分区按时间升序，之后的分区都不过期
+        }
+        {
+            QMutexLocker locker(&mutex);
+            knownPartitions.remove(partition);
+        }
+        if(!databaseManager->dropTable(partition))
+        {
+            return -1;
+        }
+        dropCount++;
+    }
+    return dropCount;
+}
+/*
+ *@brief:   分区表不存在时按表结构创建，并在时间列上建立索引
+ *@date:    2026.10.19
+ *@param:   partition:分区表名
+ *@return:  返回值为布尔类型，true:分区表可用，false:创建失败
+ */
+bool PartitionedTable::ensurePartition(const QString &partition)
+{
+    QMutexLocker locker(&mutex);
+    if(knownPartitions.contains(partition))
+    {
+        return true;
+    }
+    if(!databaseManager->isExistTable(partition))
+    {
+        if(columnNames.isEmpty())
+        {
+            qDebug()<<"partitioned table has no schema:"<<tableName;
+            return false;
+        }
+        if(!databaseManager->createTable(partition,columnNames,columnTypes,tableConstraint))
+        {
+            return false;
+        }
+        QString indexSql = QString("create index if not exists %1_%2_idx on %1(%2);").arg(partition,timeColumnName);
+        if(!databaseManager->createTable(indexSql))
+        {
+            return false;
+        }
+    }
+    knownPartitions.insert(partition);
+    return true;
+}
+
+qint64 PartitionedTable::partitionStart(qint64 time)
+{
+    qint64 span = partitionSpan();
+    return time-((time%span)+span)%span;//负数时间同样向下取整
+}
+
+qint64 PartitionedTable::partitionSpan()
+{
+    return granularity == Hourly ? 3600 : 86400;
+}
+/*
+ *@brief:   由分区表名解析分区的起始时间
+ *@date:    2026.10.19
+ *@param:   partition:分区表名
+ *@return:  qint64:分区起始时间(UTC秒数) 不是该表的分区时返回-1
+ */
+qint64 PartitionedTable::partitionStartOf(const QString &partition)
+{
+    QString prefix = tableName+"_p";
+    int suffixSize = (granularity == Hourly) ? 10 : 8;//yyyyMMddhh yyyyMMdd
+    if(!partition.startsWith(prefix) || partition.size() != prefix.size()+suffixSize)
+    {
+        return -1;
+    }
+    //日期和小时分开解析后直接构造UTC时间 QDateTime::fromString()按本地时间解析，
+    //夏令时跳过的那个小时会被当作无效时间
+    QString suffix = partition.mid(prefix.size());
+    QDate date = QDate::fromString(suffix.left(8),"yyyyMMdd");
+    int hour = 0;
+    bool isOk = true;
+    if(granularity == Hourly)
+    {
+        hour = suffix.mid(8).toInt(&isOk);
+    }
+    if(!date.isValid() || !isOk || hour < 0 || hour > 23)
+    {
+        return -1;
+    }
+    QDateTime dateTime(date,QTime(hour,0),Qt::UTC);
+    return dateTime.toMSecsSinceEpoch()/1000;
+}
+
+QStringList PartitionedTable::partitionsInRange(qint64 startTime, qint64 endTime)
+{
+    QStringList partitionList;
+    QStringList allPartitions = partitions();
+    for(int i=0;i<allPartitions.size();i++)
+    {
+        qint64 start = partitionStartOf(allPartitions.at(i));
+        if(start < endTime && start+partitionSpan() > startTime)
+        {
+            partitionList.append(allPartitions.at(i));
+        }
+    }
+    return partitionList;
+}
+
+QString PartitionedTable::rangeWhereSql(qint64 startTime, qint64 endTime, const QString &whereSql)
+{
+    QString rangeSql = QString("%1 >= %2 and %1 < %3").arg(timeColumnName).arg(startTime).arg(endTime);
+    if(!whereSql.isEmpty())
+    {
+        rangeSql.append(" and ("+whereSql+")");
+    }
+    return rangeSql;
+}
@@ -0,0 +1,82 @@
+/*
+ *@file:   partitionedtable.h
+ *@date:   2026.10.19
+ *@brief:  按时间分区的表
+ * 只追加的遥测类数据表，原来通过deleteTable(table,"ts < ...")清理过期数据，删除大量
+ * 行需要改写大量的B-tree页，删除后的空间也只是进入空闲列表，数据库文件并不会变小。
+ * 分区表把一个逻辑表按时间(每天或每小时)拆分成多个物理表，表名为"逻辑表名_p时间"，
+ * 例如aa_p20261019、aa_p2026101908：
+ *   写入:按时间列的值路由到对应的分区表，分区表不存在时自动按设置的表结构创建，并在
+ *        时间列上建立索引。
+ *   查询:找出时间范围涉及的分区，依次查询后按时间顺序合并结果。
+ *   清理:dropPartitionsBefore()直接删除整个过期的分区表(dropTable)，而不是逐行删除。
+ *
+ * 用法:
+ *   PartitionedTable telemetry(databaseManager,"telemetry","ts",PartitionedTable::Daily);
+ *   telemetry.setSchema(columnNames,columnTypes);
+ *   telemetry.insert(rowValues);
+ *   QList<QVariantList> rows = telemetry.selectRows(columnNames,startTime,endTime);
+ *   telemetry.dropPartitionsBefore(QDateTime::currentDateTimeUtc().addDays(-7).toMSecsSinceEpoch()/1000);
+ *
+ * 注:1.时间列的值为UTC秒数(自1970-01-01 00:00:00)，分区边界也按UTC划分。
+ *    2.查询的时间范围为[startTime,endTime)。
+ *    3.该类的各接口可以在多个线程中调用，具体的读写由DatabaseManager加锁。
+ */
+#ifndef PARTITIONEDTABLE_H
+#define PARTITIONEDTABLE_H
+
+#include <QSet>
+#include <QMutex>
+#include <QDateTime>
+#include "databasemanager.h"
+
+class PartitionedTable
+{
+public:
+    enum Granularity
+    {
+        Hourly,//每小时一个分区
+        Daily//每天一个分区
+    };
+    PartitionedTable(DatabaseManager *databaseManager,QString tableName,QString timeColumnName,
+                     Granularity granularity=Daily);
+
+    //设置分区表的表结构 新建分区时使用，必须包含时间列
+    void setSchema(QList<QString> columnNames,QList<QString> columnTypes,QString tableConstraint=QString());
+    QString partitionName(qint64 time);//时间所在分区的表名
+    QStringList partitions();//已存在的分区表名 按时间升序
+
+    /******数据更新 参数同DatabaseManager的同名接口，必须插入完整的元组**********/
+    bool insert(QVariantList &rowValues);
+    bool insertBatch(QList<QVariantList> &columnValues);//按分区分组后分别批量插入
+
+    /******数据查询 时间范围为[startTime,endTime)**********/
+    QList<QVariantList> selectRows(QList<QString> columnNames,qint64 startTime,qint64 endTime,QString whereSql=QString());
+    QVariantList selectSingleColDatas(QString columnName,qint64 startTime,qint64 endTime,QString whereSql=QString());
+    int selectRowCount(qint64 startTime,qint64 endTime,QString whereSql=QString());
+
+    //保留策略 删除分区结束时间不晚于time的整个分区表，返回删除的分区数，失败返回-1
+    int dropPartitionsBefore(qint64 time);
+
+private:
+    bool ensurePartition(const QString &partition);//分区表不存在时创建
+    qint64 partitionStart(qint64 time);//时间所在分区的起始时间
+    qint64 partitionSpan();//一个分区的时长(秒)
+    qint64 partitionStartOf(const QString &partition);//由分区表名解析分区的起始时间，无效返回-1
+    QStringList partitionsInRange(qint64 startTime,qint64 endTime);
+    QString rangeWhereSql(qint64 startTime,qint64 endTime,const QString &whereSql);
+
+    DatabaseManager *databaseManager;
+    QString tableName;//逻辑表名
+    QString timeColumnName;//时间列名
+    Granularity granularity;
+    QList<QString> columnNames;//分区表结构
+    QList<QString> columnTypes;
+    QString tableConstraint;
+    int timeColumnIndex;//时间列在元组中的下标
+
+    QMutex mutex;//保护已知分区的集合
+    QSet<QString> knownPartitions;//已确认存在的分区表
+};
+
+#endif // PARTITIONEDTABLE_H
@@ -0,0 +1,167 @@
+/*
+ *@file:   readsnapshot.cpp
+ *@date:   2026.10.19
+ *@brief:  数据库读快照
+ */
+#include "readsnapshot.h"
+#include <QAtomicInt>
+
+//快照读连接的序号，保证每个快照的连接名唯一
+static QAtomicInt snapshotSerial(0);
+
+/*
+ *@brief:   创建读快照 新建一个读连接并开启读事务
+ *@date:    2026.10.19
+ *@param:   databaseManager:主连接的数据库管理对象
+ */
+ReadSnapshot::ReadSnapshot(DatabaseManager *databaseManager)
+    :reader(0)
+{
+    QString databaseName = databaseManager->databaseName();
+    if(databaseName.isEmpty() || databaseName == ":memory:")
+    {
+        qDebug()<<"read snapshot error: database is not a shareable file"<<databaseName;
+        return;
+    }
+    //读快照依赖WAL模式，回滚日志模式下读事务会阻塞主连接的写操作
+    if(!databaseManager->enableWalMode())
+    {
+        return;
+    }
+    QString readerName = QString("%1_snapshot_%2").arg(databaseManager->connectionName)
+            .arg(snapshotSerial.fetchAndAddRelaxed(1));
+    reader = new DatabaseManager(readerName);
+    reader->shareCodecDictionaries(databaseManager);//快照读到的压缩值同样需要解压
+    if(!reader->createSqliteConnection(databaseName))
+    {
+        release();
+        return;
+    }
+    if(!reader->db.transaction())
+    {
+        qDebug()<<"read snapshot transaction error:"<<reader->db.lastError();
+        release();
+        return;
+    }
+    /*deferred事务在第一次读数据库时才真正获取读锁并确定快照时刻，这里立即读一次
+     *sqlite_master，使快照时刻就是构造的时刻*/
+    QSqlQuery query(reader->db);//创建sql语句执行对象
+    if(!query.exec("select count(0) from sqlite_master;"))
+    {
+        qDebug()<<"read snapshot error:"<<query.lastError();
+        query.finish();
+        release();
+        return;
+    }
+    query.finish();
+}
+
+ReadSnapshot::~ReadSnapshot()
+{
+    release();
+}
+/*
+ *@brief:   快照是否创建成功
+ *@date:    2026.10.19
+ *@return:  bool:true=有效　false=无效
+ */
+bool ReadSnapshot::isValid()
+{
+    return reader != 0;
+}
+/*
+ *@brief:   结束读事务并关闭读连接 之后快照失效
+ *@date:    2026.10.19
+ */
+void ReadSnapshot::release()
+{
+    if(!reader)
+    {
+        return;
+    }
+    //只读事务回滚与提交效果相同，回滚不会因为其他连接持有锁而失败
+    reader->db.rollback();
+    delete reader;//析构时关闭连接
+    reader = 0;
+}
+
+QVariant ReadSnapshot::selectSingleColData(QString tableName, QString columnName, QString whereSql)
+{
+    if(!reader)
+    {
+        return QVariant();
+    }
+    return reader->selectSingleColData(tableName,columnName,whereSql);
+}
+
+QVariant ReadSnapshot::selectSingleColData(QString tableName, QString columnName, QString whereColName, QVariant whereColValue)
+{
+    if(!reader)
+    {
+        return QVariant();
+    }
+    return reader->selectSingleColData(tableName,columnName,whereColName,whereColValue);
+}
+
+QVariantList ReadSnapshot::selectMultiColData(QString tableName, QList<QString> columnNames, QString whereSql)
+{
+    if(!reader)
+    {
+        return QVariantList();
+    }
+    return reader->selectMultiColData(tableName,columnNames,whereSql);
+}
+
+QVariantList ReadSnapshot::selectMultiColData(QString tableName, QList<QString> columnNames, QString whereColName, QVariant whereColValue)
+{
+    if(!reader)
+    {
+        return QVariantList();
+    }
+    return reader->selectMultiColData(tableName,columnNames,whereColName,whereColValue);
+}
+
+QHash<QString,QVariantList> ReadSnapshot::selectBatchMultiColData(QString tableName, QList<QString> columnNames, QString whereColName, QVariantList whereColValues)
+{
+    if(!reader)
+    {
+        return QHash<QString,QVariantList>();
+    }
+    return reader->selectBatchMultiColData(tableName,columnNames,whereColName,whereColValues);
+}
+
+QVariantList ReadSnapshot::selectSingleColDatas(QString tableName, QString columnName, bool isDistinct, QString whereSql)
+{
+    if(!reader)
+    {
+        return QVariantList();
+    }
+    return reader->selectSingleColDatas(tableName,columnName,isDistinct,whereSql);
+}
+
+QVariantList ReadSnapshot::selectSingleColDatas(QString tableName, QString columnName, QString whereColName, QVariant whereColValue, bool isDistinct)
+{
+    if(!reader)
+    {
+        return QVariantList();
+    }
+    return reader->selectSingleColDatas(tableName,columnName,whereColName,whereColValue,isDistinct);
+}
+
+int ReadSnapshot::selectRowCount(QString tableName, QString whereSql)
+{
+    if(!reader)
+    {
+        return -1;
+    }
+    return reader->selectRowCount(tableName,whereSql);
+}
+
+bool ReadSnapshot::isExistTable(QString tableName)
+{
+    if(!reader)
+    {
+        return false;
+    }
+    return reader->isExistTable(tableName);
+}
@@ -0,0 +1,52 @@
+/*
+ *@file:   readsnapshot.h
+ *@date:   2026.10.19
+ *@brief:  数据库读快照
+ * 要在多次查询之间得到一致的数据，原来只能在所有查询外面加写锁，这期间所有的写操
+ * 作都会被阻塞。读快照在构造时为数据库新建一个专用的读连接，并在该连接上开启一个
+ * 读事务。在WAL模式下，读事务开始后看到的始终是开启时刻的数据，主连接上的写操作
+ * 可以照常提交，互不影响。
+ *
+ * 用法:
+ *   ReadSnapshot snapshot(databaseManager);
+ *   if(snapshot.isValid())
+ *   {
+ *       snapshot.selectRowCount("aa");
+ *       snapshot.selectSingleColDatas("aa","id");//与上一条查询看到的是同一时刻的数据
+ *   }
+ * 快照析构(或调用release())时结束读事务并关闭读连接。
+ * 注:1.读快照需要数据库处于WAL模式，构造时会自动将主连接切换为WAL模式(持久生效)。
+ *    2.内存数据库(:memory:)无法被其他连接共享，不支持读快照。
+ *    3.与QSqlDatabase一样，快照只能在创建它的线程中使用。
+ *    4.读事务持续期间WAL文件无法被完全checkpoint,快照不宜长时间持有。
+ */
+#ifndef READSNAPSHOT_H
+#define READSNAPSHOT_H
+
+#include "databasemanager.h"
+
+class ReadSnapshot
+{
+public:
+    explicit ReadSnapshot(DatabaseManager *databaseManager);
+    ~ReadSnapshot();
+
+    bool isValid();//快照是否创建成功
+    void release();//结束读事务并关闭读连接
+
+    /******数据查询 参数及返回值同DatabaseManager的同名接口**********/
+    QVariant selectSingleColData(QString tableName,QString columnName,QString whereSql);
+    QVariant selectSingleColData(QString tableName,QString columnName,QString whereColName,QVariant whereColValue);
+    QVariantList selectMultiColData(QString tableName,QList<QString> columnNames,QString whereSql);
+    QVariantList selectMultiColData(QString tableName,QList<QString> columnNames,QString whereColName,QVariant whereColValue);
+    QHash<QString,QVariantList> selectBatchMultiColData(QString tableName,QList<QString> columnNames,QString whereColName,QVariantList whereColValues);
+    QVariantList selectSingleColDatas(QString tableName,QString columnName,bool isDistinct=true,QString whereSql=QString());
+    QVariantList selectSingleColDatas(QString tableName,QString columnName,QString whereColName,QVariant whereColValue,bool isDistinct=true);
+    int selectRowCount(QString tableName,QString whereSql=QString());
+    bool isExistTable(QString tableName);
+
+private:
+    DatabaseManager *reader;//快照专用的读连接
+};
+
+#endif // READSNAPSHOT_H
@@ -0,0 +1,173 @@
+/*
+ *@file:   recordmapping.h
+ *@date:   2026.10.19
+ *@brief:  结构体到表字段的映射 用于DatabaseManager::insertRecords()
+ * insertBatchTable()要求调用者把记录按列转置成QVariantList(见MyThread)，每个单元格都要装箱成一个
+ * QVariant。RecordMapping按成员指针记录结构体的各个字段与列名的对应关系，insertRecords()在
+ * 原生接口下直接从连续存放的std::vector<Record>中读取成员并绑定到语句，不经过QVariant。例:
+ *    struct StudentRecord { int id; QString name; double score; int age; };
+ *    template<>
+ *    const RecordMapping<StudentRecord> &recordMapping<StudentRecord>()
+ *    {
+ *        static const RecordMapping<StudentRecord> mapping = RecordMapping<StudentRecord>()
+ *                .column("id",&StudentRecord::id).column("name",&StudentRecord::name)
+ *                .column("score",&StudentRecord::score).column("age",&StudentRecord::age);
+ *        return mapping;
+ *    }
+ *    std::vector<StudentRecord> records;
+ *    ...
+ *    databaseManager->insertRecords("student",records);
+ *
+ * 注:1.成员类型支持int/uint/qint64/quint64/bool/double/float/QString/QByteArray，其他类型编译报错。
+ *    2.recordMapping<Record>()的特化需要在调用insertRecords()之前可见，多个源文件使用同一个
+ *      结构体时，在头文件中声明该特化:template<> const RecordMapping<Record> &recordMapping<Record>();
+ */
+#ifndef RECORDMAPPING_H
+#define RECORDMAPPING_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QList>
+#include <QSharedPointer>
+#include "sqlitestatement.h"
+
+/*****成员值的绑定 按成员类型重载，不支持的类型没有对应的重载*******/
+/*SqliteStatement的绑定方法只在定义了SQLITE_NATIVE_API时实现，未定义时不编译绑定相关的代码，
+ *insertRecords()通过toColumnValues()走QSqlQuery的批处理*/
+#ifdef SQLITE_NATIVE_API
+inline bool bindRecordField(SqliteStatement &statement,int index,int value)
+{
+    return statement.bindInt64(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,uint value)
+{
+    return statement.bindInt64(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,qint64 value)
+{
+    return statement.bindInt64(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,quint64 value)
+{
+    return statement.bindInt64(index,qint64(value));
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,bool value)
+{
+    return statement.bindInt64(index,value ? 1 : 0);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,double value)
+{
+    return statement.bindDouble(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,float value)
+{
+    return statement.bindDouble(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,const QString &value)
+{
+    return statement.bindText(index,value);
+}
+inline bool bindRecordField(SqliteStatement &statement,int index,const QByteArray &value)
+{
+    return statement.bindBlob(index,value);
+}
+#endif
+//QSqlQuery执行时使用的值 float转为double，避免QVariant::Float被当成文本绑定
+template<typename T>
+inline QVariant recordFieldValue(const T &value)
+{
+    return QVariant(value);
+}
+inline QVariant recordFieldValue(float value)
+{
+    return QVariant(double(value));
+}
+
+template<typename Record>
+class RecordMapping
+{
+public:
+    //添加一列 name:列名 member:对应的成员指针
+    template<typename T>
+    RecordMapping &column(const QString &name,T Record::*member)
+    {
+        fields.append(QSharedPointer<Field>(new MemberField<T>(member)));
+        names.append(name);
+        return *this;
+    }
+    int columnCount() const
+    {
+        return fields.size();
+    }
+    const QStringList &columnNames() const
+    {
+        return names;
+    }
+#ifdef SQLITE_NATIVE_API
+    //将一条记录的所有成员按列的顺序绑定到语句
+    bool bind(SqliteStatement &statement,const Record &record) const
+    {
+        for(int i=0;i<fields.size();i++)
+        {
+            if(!fields.at(i)->bind(statement,i,record))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+#endif
+    //按列转置成QVariantList 用于原生接口不可用时通过QSqlQuery批处理
+    template<typename Container>
+    QList<QVariantList> toColumnValues(const Container &records) const
+    {
+        QList<QVariantList> columnValues;
+        for(int i=0;i<fields.size();i++)
+        {
+            QVariantList values;
+            values.reserve(int(records.size()));
+            for(typename Container::const_iterator it=records.begin();it!=records.end();++it)
+            {
+                values.append(fields.at(i)->value(*it));
+            }
+            columnValues.append(values);
+        }
+        return columnValues;
+    }
+
+private:
+    struct Field
+    {
+        virtual ~Field(){}
+#ifdef SQLITE_NATIVE_API
+        virtual bool bind(SqliteStatement &statement,int index,const Record &record) const = 0;
+#endif
+        virtual QVariant value(const Record &record) const = 0;
+    };
+    template<typename T>
+    struct MemberField : public Field
+    {
+        explicit MemberField(T Record::*member):member(member){}
+#ifdef SQLITE_NATIVE_API
+        bool bind(SqliteStatement &statement,int index,const Record &record) const
+        {
+            return bindRecordField(statement,index,record.*member);
+        }
+#endif
+        QVariant value(const Record &record) const
+        {
+            return recordFieldValue(record.*member);
+        }
+        T Record::*member;
+    };
+
+    QList<QSharedPointer<Field> > fields;
+    QStringList names;
+};
+
+//结构体的默认映射 由使用者针对具体的结构体特化
+template<typename Record>
+const RecordMapping<Record> &recordMapping();
+
+#endif // RECORDMAPPING_H
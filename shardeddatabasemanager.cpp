@@ -0,0 +1,616 @@
+/*
+ *@file:   shardeddatabasemanager.cpp
+ *@date:   2026.10.19
+ *@brief:  多数据库文件分片管理
+ */
+#include "shardeddatabasemanager.h"
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFuture>
+#include <QFileInfo>
+#include <QVector>
+#include <QSet>
+#include <QPair>
+#include <QMutexLocker>
+
+//值为整数类型时聚合结果保持整数
+static bool isIntegerVariant(const QVariant &value)
+{
+    switch(value.type())
+    {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+        return true;
+    default:
+        return false;
+    }
+}
+//合并各分片的min/max 与sqlite一致，数值按大小比较，文本按字符串比较
+static bool variantLessThan(const QVariant &left, const QVariant &right)
+{
+    if(left.type() == QVariant::String || right.type() == QVariant::String)
+    {
+        return left.toString() < right.toString();
+    }
+    return left.toDouble() < right.toDouble();
+}
+
+/*
+ *@brief:   在所有分片上并行执行task 只有一个分片时直接在当前线程执行
+ *@date:    2026.10.19
+ *@param:   task:对单个分片的操作
+ *@return:  QList<Result>:各分片的结果 按分片顺序
+ */
+template<typename Result>
+QList<Result> ShardedDatabaseManager::runOnShards(std::function<Result(DatabaseManager*)> task)
+{
+    QList<Result> results;
+    if(shards.size() == 1)
+    {
+        results.append(task(shards.first()));
+        return results;
+    }
+    QList<QFuture<Result> > futures;
+    for(int i=0;i<shards.size();i++)
+    {
+        DatabaseManager *shard = shards.at(i);
+        futures.append(QtConcurrent::run(&threadPool,[task,shard](){
+            return task(shard);
+        }));
+    }
+    for(int i=0;i<futures.size();i++)
+    {
+        results.append(futures[i].result());
+    }
+    return results;
+}
+
+/*
+ *@brief:   构造分片管理对象 每个分片对应一个DatabaseManager，连接名为connectionName_序号
+ *@date:    2026.10.19
+ *@param:   connectionName:连接名前缀
+ *@param:   shardCount:分片数
+ */
+ShardedDatabaseManager::ShardedDatabaseManager(QString connectionName, int shardCount)
+    :connectionName(connectionName)
+{
+    shardCount = qMax(shardCount,1);
+    for(int i=0;i<shardCount;i++)
+    {
+        shards.append(new DatabaseManager(QString("%1_%2").arg(connectionName).arg(i)));
+    }
+    threadPool.setMaxThreadCount(shardCount);//每个分片一个线程，各分片的sql可以同时执行
+}
+
+ShardedDatabaseManager::~ShardedDatabaseManager()
+{
+    threadPool.waitForDone();
+    closeConnection();
+    qDeleteAll(shards);
+}
+/*
+ *@brief:   创建各分片的sqlite连接
+ *@date:    2026.10.19
+ *@param:   databaseName:数据库文件名 各分片的文件名在后缀前加上分片序号
+ *@param:   options:连接选项 所有分片相同
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool ShardedDatabaseManager::createSqliteConnection(QString databaseName, SqliteConnectionOptions options)
+{
+    QFileInfo fileInfo(databaseName);
+    QString basePath = fileInfo.path()+"/"+fileInfo.completeBaseName();
+    QString suffix = fileInfo.suffix().isEmpty() ? QString() : "."+fileInfo.suffix();
+    for(int i=0;i<shards.size();i++)
+    {
+        if(!shards.at(i)->createSqliteConnection(QString("%1_%2%3").arg(basePath).arg(i).arg(suffix),options))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ShardedDatabaseManager::closeConnection()
+{
+    for(int i=0;i<shards.size();i++)
+    {
+        shards.at(i)->closeConnection();
+    }
+}
+
+int ShardedDatabaseManager::shardCount()
+{
+    return shards.size();
+}
+
+DatabaseManager *ShardedDatabaseManager::shard(int index)
+{
+    return shards.value(index,0);
+}
+/*
+ *@brief:   计算键值所在的分片 对键值的字符串形式计算FNV-1a哈希，结果与进程和Qt版本无关
+ *@date:    2026.10.19
+ *@param:   keyValue:分片键的值
+ *@return:  int:分片序号
+ */
+int ShardedDatabaseManager::shardOf(const QVariant &keyValue)
+{
+    QByteArray key = keyValue.toString().toUtf8();
+    quint32 hash = 2166136261u;
+    for(int i=0;i<key.size();i++)
+    {
+        hash ^= quint8(key.at(i));
+        hash *= 16777619u;
+    }
+    return int(hash%quint32(shards.size()));
+}
+/*
+ *@brief:   在所有分片上建表，并以keyColumnName作为该表的分片键
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnNames:列名
+ *@param:   columnTypes:列类型
+ *@param:   keyColumnName:分片键 必须是columnNames中的列
+ *@param:   tableConstraint:表约束 唯一性约束只在各分片内有效，包含分片键时全局有效
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool ShardedDatabaseManager::createTable(QString tableName, QList<QString> &columnNames, QList<QString> &columnTypes,
+                                         QString keyColumnName, QString tableConstraint)
+{
+    if(!columnNames.contains(keyColumnName))
+    {
+        qDebug()<<"sharded create table error: key column isn't in the columns..."<<tableName<<keyColumnName;
+        return false;
+    }
+    bool isSuccess = execOnShards([=](DatabaseManager *shard){
+        QList<QString> names = columnNames;
+        QList<QString> types = columnTypes;
+        return shard->createTable(tableName,names,types,tableConstraint);
+    });
+    if(!isSuccess)
+    {
+        return false;
+    }
+    ShardedTable table;
+    table.keyColumnName = keyColumnName;
+    table.columnNames = columnNames;
+    QMutexLocker locker(&tableMutex);
+    tables.insert(tableName.toLower(),table);
+    return true;
+}
+/*
+ *@brief:   登记已存在的表的分片键 表的列名从第一个分片读取
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   keyColumnName:分片键
+ *@return:  返回值为布尔类型，true:成功，false:表或列不存在
+ */
+bool ShardedDatabaseManager::setShardKey(QString tableName, QString keyColumnName)
+{
+    ShardedTable table;
+    table.keyColumnName = keyColumnName;
+    table.columnNames = shards.first()->selectColumnNames(tableName);
+    if(!table.columnNames.contains(keyColumnName))
+    {
+        qDebug()<<"sharded table error: table or key column doesn't exist..."<<tableName<<keyColumnName;
+        return false;
+    }
+    QMutexLocker locker(&tableMutex);
+    tables.insert(tableName.toLower(),table);
+    return true;
+}
+
+/*
+ *@brief:   在所有分片上配置列压缩 同DatabaseManager::setColumnCompression()
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnName:压缩的列名
+ *@param:   options:压缩选项
+ *@return:  返回值为布尔类型，true:所有分片都配置成功，false:失败
+ */
+bool ShardedDatabaseManager::setColumnCompression(QString tableName, QString columnName, ColumnCompressionOptions options)
+{
+    bool isSuccess = true;
+    for(int i=0;i<shards.size();i++)
+    {
+        isSuccess = shards.at(i)->setColumnCompression(tableName,columnName,options) && isSuccess;
+    }
+    return isSuccess;
+}
+
+bool ShardedDatabaseManager::dropTable(QString tableName)
+{
+    {
+        QMutexLocker locker(&tableMutex);
+        tables.remove(tableName.toLower());
+    }
+    return execOnShards([=](DatabaseManager *shard){
+        return shard->dropTable(tableName);
+    });
+}
+/*
+ *@brief:   插入单条数据 按分片键的值写入一个分片
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   rowValues:元组数据
+ *@param:   columnNames:列名 为空表示完整的元组数据
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool ShardedDatabaseManager::insertTable(QString tableName, QVariantList &rowValues, QList<QString> columnNames)
+{
+    int position = keyPosition(tableName,columnNames);
+    if(position < 0 || position >= rowValues.size())
+    {
+        return false;
+    }
+    return shards.at(shardOf(rowValues.at(position)))->insertTable(tableName,rowValues,columnNames);
+}
+/*
+ *@brief:   批量插入多条数据 先按分片分组，再由各分片并行批量插入(各自的事务)
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@param:   columnValues:按列组织的元组数据
+ *@param:   columnNames:列名 为空表示完整的元组数据
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool ShardedDatabaseManager::insertBatchTable(QString tableName, QList<QVariantList> &columnValues, QList<QString> columnNames)
+{
+    int position = keyPosition(tableName,columnNames);
+    if(position < 0 || position >= columnValues.size())
+    {
+        return false;
+    }
+    int columnCount = columnValues.size();
+    const QVariantList &keyValues = columnValues.at(position);
+    QVector<QList<QVariantList> > shardValues(shards.size());//分片序号->该分片按列组织的数据
+    for(int row=0;row<keyValues.size();row++)
+    {
+        QList<QVariantList> &values = shardValues[shardOf(keyValues.at(row))];
+        if(values.isEmpty())
+        {
+            for(int i=0;i<columnCount;i++)
+            {
+                values.append(QVariantList());
+            }
+        }
+        for(int i=0;i<columnCount;i++)
+        {
+            values[i].append(columnValues.at(i).at(row));
+        }
+    }
+    return execOnShards([&](DatabaseManager *shard){
+        QList<QVariantList> values = shardValues.at(shards.indexOf(shard));
+        if(values.isEmpty())
+        {
+            return true;//该分片没有数据
+        }
+        return shard->insertBatchTable(tableName,values,columnNames);
+    });
+}
+/*
+ *@brief:   按条件列修改数据 条件列为分片键时只修改一个分片
+ *@date:    2026.10.19
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool ShardedDatabaseManager::updateTable(QString tableName, QList<QString> &columnNames, QVariantList &rowValues,
+                                         QString whereColName, QVariant whereColValue)
+{
+    for(int i=0;i<columnNames.size();i++)
+    {
+        if(isShardKey(tableName,columnNames.at(i)))
+        {
+            qDebug()<<"sharded update error: the shard key can't be modified..."<<tableName<<columnNames.at(i);
+            return false;
+        }
+    }
+    if(isShardKey(tableName,whereColName))
+    {
+        return shards.at(shardOf(whereColValue))->updateTable(tableName,columnNames,rowValues,whereColName,whereColValue);
+    }
+    return execOnShards([=](DatabaseManager *shard){
+        QList<QString> names = columnNames;
+        QVariantList values = rowValues;
+        return shard->updateTable(tableName,names,values,whereColName,whereColValue);
+    });
+}
+
+bool ShardedDatabaseManager::updateTable(QString tableName, QList<QString> &columnNames, QVariantList &rowValues, QString whereSql)
+{
+    for(int i=0;i<columnNames.size();i++)
+    {
+        if(isShardKey(tableName,columnNames.at(i)))
+        {
+            qDebug()<<"sharded update error: the shard key can't be modified..."<<tableName<<columnNames.at(i);
+            return false;
+        }
+    }
+    return execOnShards([=](DatabaseManager *shard){
+        QList<QString> names = columnNames;
+        QVariantList values = rowValues;
+        return shard->updateTable(tableName,names,values,whereSql);
+    });
+}
+
+bool ShardedDatabaseManager::deleteTable(QString tableName, QString whereColName, QVariant whereColValue)
+{
+    if(isShardKey(tableName,whereColName))
+    {
+        return shards.at(shardOf(whereColValue))->deleteTable(tableName,whereColName,whereColValue);
+    }
+    return execOnShards([=](DatabaseManager *shard){
+        return shard->deleteTable(tableName,whereColName,whereColValue);
+    });
+}
+
+bool ShardedDatabaseManager::deleteTable(QString tableName, QString whereSql)
+{
+    return execOnShards([=](DatabaseManager *shard){
+        return shard->deleteTable(tableName,whereSql);
+    });
+}
+/*
+ *@brief:   查询单行多列的数据 条件列为分片键时只查询一个分片
+ *@date:    2026.10.19
+ *@param:   columnNames:查询的列名 为空则查询整行数据
+ *@return:  QVariantList:列数据 不存在时为空
+ */
+QVariantList ShardedDatabaseManager::selectMultiColData(QString tableName, QList<QString> columnNames, QString whereColName,
+                                                        QVariant whereColValue)
+{
+    if(isShardKey(tableName,whereColName))
+    {
+        return shards.at(shardOf(whereColValue))->selectMultiColData(tableName,columnNames,whereColName,whereColValue);
+    }
+    QList<QVariantList> results = runOnShards<QVariantList>([=](DatabaseManager *shard){
+        return shard->selectMultiColData(tableName,columnNames,whereColName,whereColValue);
+    });
+    for(int i=0;i<results.size();i++)
+    {
+        if(!results.at(i).isEmpty())
+        {
+            return results.at(i);
+        }
+    }
+    return QVariantList();
+}
+/*
+ *@brief:   并行查询所有分片的多行多列数据 按分片顺序合并
+ *@date:    2026.10.19
+ *@param:   columnNames:查询的列名 为空则查询整行数据
+ *@param:   whereSql:条件 为空表示查询全部
+ *@return:  QList<QVariantList>:每个元素为一行数据，失败返回空的列表
+ */
+QList<QVariantList> ShardedDatabaseManager::selectRows(QString tableName, QList<QString> columnNames, QString whereSql)
+{
+    typedef QPair<bool,QList<QVariantList> > ShardRows;
+    QList<ShardRows> results = runOnShards<ShardRows>([=](DatabaseManager *shard){
+        ShardRows shardRows(false,QList<QVariantList>());
+        ArenaResultSet resultSet;
+        if(!shard->selectResultSet(resultSet,tableName,columnNames,whereSql))
+        {
+            return shardRows;
+        }
+        int rowCount = resultSet.rowCount();
+        int columnCount = resultSet.columnCount();
+        for(int row=0;row<rowCount;row++)
+        {
+            QVariantList rowValues;
+            rowValues.reserve(columnCount);
+            for(int column=0;column<columnCount;column++)
+            {
+                rowValues.append(resultSet.value(row,column));
+            }
+            shardRows.second.append(rowValues);
+        }
+        shardRows.first = true;
+        return shardRows;
+    });
+    QList<QVariantList> rows;
+    for(int i=0;i<results.size();i++)
+    {
+        if(!results.at(i).first)
+        {
+            return QList<QVariantList>();
+        }
+        rows.append(results.at(i).second);
+    }
+    return rows;
+}
+/*
+ *@brief:   并行查询所有分片的多行单列数据 isDistinct为true时合并后再去重
+ *@date:    2026.10.19
+ *@return:  QVariantList:列数据
+ */
+QVariantList ShardedDatabaseManager::selectSingleColDatas(QString tableName, QString columnName, bool isDistinct, QString whereSql)
+{
+    QList<QVariantList> results = runOnShards<QVariantList>([=](DatabaseManager *shard){
+        return shard->selectSingleColDatas(tableName,columnName,isDistinct,whereSql);
+    });
+    QVariantList values;
+    QSet<QString> distinctValues;
+    for(int i=0;i<results.size();i++)
+    {
+        const QVariantList &shardValues = results.at(i);
+        for(int j=0;j<shardValues.size();j++)
+        {
+            if(isDistinct)
+            {
+                QString key = shardValues.at(j).toString();
+                if(distinctValues.contains(key))
+                {
+                    continue;
+                }
+                distinctValues.insert(key);
+            }
+            values.append(shardValues.at(j));
+        }
+    }
+    return values;
+}
+/*
+ *@brief:   并行查询所有分片的行数并求和
+ *@date:    2026.10.19
+ *@return:  int:行数 失败返回-1
+ */
+int ShardedDatabaseManager::selectRowCount(QString tableName, QString whereSql)
+{
+    QList<int> results = runOnShards<int>([=](DatabaseManager *shard){
+        return shard->selectRowCount(tableName,whereSql);
+    });
+    int rowCount = 0;
+    for(int i=0;i<results.size();i++)
+    {
+        if(results.at(i) < 0)
+        {
+            return -1;
+        }
+        rowCount += results.at(i);
+    }
+    return rowCount;
+}
+/*
+ *@brief:   聚合查询 各分片并行计算部分结果后合并:count/sum求和，min/max取最值，
+ * avg由各分片的sum和count计算，不能直接对各分片的平均值求平均
+ *@date:    2026.10.19
+ *@param:   function:聚合函数 count/sum/min/max/avg
+ *@param:   columnName:列名
+ *@param:   whereSql:条件 为空表示全部数据
+ *@return:  QVariant:聚合结果 失败或没有数据时返回无效的数据(count返回0)
+ */
+QVariant ShardedDatabaseManager::selectAggregate(QString tableName, QString function, QString columnName, QString whereSql)
+{
+    function = function.trimmed().toLower();
+    QList<QString> columnNames;
+    if(function == "avg")
+    {
+        columnNames<<QString("sum(%1)").arg(columnName)<<QString("count(%1)").arg(columnName);
+    }
+    else if(function == "count" || function == "sum" || function == "min" || function == "max")
+    {
+        columnNames<<QString("%1(%2)").arg(function,columnName);
+    }
+    else
+    {
+        qDebug()<<"sharded aggregate error: unsupported function..."<<function;
+        return QVariant();
+    }
+    typedef QPair<bool,QVariantList> ShardValues;
+    QList<ShardValues> results = runOnShards<ShardValues>([=](DatabaseManager *shard){
+        ArenaResultSet resultSet;
+        ShardValues shardValues(false,QVariantList());
+        if(shard->selectResultSet(resultSet,tableName,columnNames,whereSql) && resultSet.rowCount() == 1)
+        {
+            shardValues.first = true;
+            for(int column=0;column<resultSet.columnCount();column++)
+            {
+                shardValues.second.append(resultSet.value(0,column));
+            }
+        }
+        return shardValues;
+    });
+    QVariant result;
+    qint64 totalCount = 0;
+    double totalSum = 0;
+    for(int i=0;i<results.size();i++)
+    {
+        if(!results.at(i).first)
+        {
+            return QVariant();
+        }
+        QVariant value = results.at(i).second.value(0);
+        if(function == "count")
+        {
+            totalCount += value.toLongLong();
+            result = totalCount;
+        }
+        else if(value.isNull())
+        {
+            continue;//该分片没有符合条件的数据
+        }
+        else if(function == "sum")
+        {
+            if(result.isNull())
+            {
+                result = value;
+            }
+            else if(isIntegerVariant(result) && isIntegerVariant(value))
+            {
+                result = result.toLongLong()+value.toLongLong();
+            }
+            else
+            {
+                result = result.toDouble()+value.toDouble();
+            }
+        }
+        else if(function == "min" || function == "max")
+        {
+            if(result.isNull() || (function == "min" ? variantLessThan(value,result) : variantLessThan(result,value)))
+            {
+                result = value;
+            }
+        }
+        else//avg
+        {
+            totalSum += value.toDouble();
+            totalCount += results.at(i).second.value(1).toLongLong();
+        }
+    }
+    if(function == "count")
+    {
+        return totalCount;
+    }
+    if(function == "avg")
+    {
+        return totalCount ? QVariant(totalSum/totalCount) : QVariant();
+    }
+    return result;
+}
+
+bool ShardedDatabaseManager::findTable(const QString &tableName, ShardedTable &table)
+{
+    QMutexLocker locker(&tableMutex);
+    QHash<QString,ShardedTable>::const_iterator it = tables.constFind(tableName.toLower());
+    if(it == tables.constEnd())
+    {
+        return false;
+    }
+    table = it.value();
+    return true;
+}
+/*
+ *@brief:   获取分片键在列名中的位置
+ *@date:    2026.10.19
+ *@param:   columnNames:写入的列名 为空表示表的全部列
+ *@return:  int:位置 表未登记分片键或列名中没有分片键时返回-1
+ */
+int ShardedDatabaseManager::keyPosition(const QString &tableName, const QList<QString> &columnNames)
+{
+    ShardedTable table;
+    if(!findTable(tableName,table))
+    {
+        qDebug()<<"sharded table error: no shard key for the table..."<<tableName;
+        return -1;
+    }
+    const QList<QString> &names = columnNames.isEmpty() ? table.columnNames : columnNames;
+    for(int i=0;i<names.size();i++)
+    {
+        if(names.at(i).trimmed().compare(table.keyColumnName,Qt::CaseInsensitive) == 0)
+        {
+            return i;
+        }
+    }
+    qDebug()<<"sharded table error: the columns don't contain the shard key..."<<tableName<<table.keyColumnName;
+    return -1;
+}
+
+bool ShardedDatabaseManager::isShardKey(const QString &tableName, const QString &columnName)
+{
+    ShardedTable table;
+    return findTable(tableName,table) && columnName.trimmed().compare(table.keyColumnName,Qt::CaseInsensitive) == 0;
+}
+bool ShardedDatabaseManager::execOnShards(std::function<bool(DatabaseManager*)> task)
+{
+    QList<bool> results = runOnShards<bool>(task);
+    return !results.contains(false);
+}
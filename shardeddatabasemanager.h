@@ -0,0 +1,102 @@
+/*
+ *@file:   shardeddatabasemanager.h
+ *@date:   2026.10.19
+ *@brief:  多数据库文件分片管理
+ * DatabaseManager针对单个数据库，SQLite同一时刻只允许一个写事务，写入量再大也只能
+ * 串行写入一个文件。ShardedDatabaseManager把一个逻辑表按分片键的哈希值分散到N个
+ * SQLite数据库文件(每个分片是一个独立的DatabaseManager，各自有自己的连接和锁):
+ *   1.按分片键的单行操作(插入、按键修改/删除/查询)只路由到一个分片，不同分片的写入
+ *     互不阻塞;
+ *   2.批量插入先按分片分组，各分片的批量插入在线程池中并行执行;
+ *   3.范围查询和聚合查询(行数、sum/min/max/avg)在所有分片上并行执行后合并结果。
+ *
+ * 用法:
+ *   ShardedDatabaseManager sharded("shard",4);
+ *   sharded.createSqliteConnection("data.db");//创建data_0.db ... data_3.db
+ *   sharded.createTable("student",columnNames,columnTypes,"id");//以id为分片键
+ *   sharded.insertTable("student",rowValues,columnNames);
+ *   QVariantList row = sharded.selectMultiColData("student",QList<QString>(),"id",101);
+ *   int count = sharded.selectRowCount("student","score > 60");
+ *
+ * 注:1.分片键的哈希(FNV-1a,按值的字符串形式计算)与Qt版本和进程无关，分片数在建库后不能修改。
+ *    2.分片键的值不能修改，updateTable()的列中包含分片键时返回失败。
+ *    3.多个分片上的写操作是各自独立的事务，某个分片失败时其他分片已完成的修改不会回滚。
+ *    4.selectRows()/selectSingleColDatas()按分片顺序合并结果，whereSql中的order by/limit
+ *      只在各分片内生效。
+ *    5.程序重启后，已存在的表需要调用setShardKey()重新登记分片键。
+ *    6.列压缩(见columncodec.h)按分片各自配置，通过setColumnCompression()在所有分片上
+ *      配置相同的压缩列，只配置某个shard()时其他分片查询返回的是未解压的BLOB。
+ */
+#ifndef SHARDEDDATABASEMANAGER_H
+#define SHARDEDDATABASEMANAGER_H
+
+#include <QThreadPool>
+#include <QMutex>
+#include <functional>
+#include "databasemanager.h"
+
+class ShardedDatabaseManager
+{
+public:
+    ShardedDatabaseManager(QString connectionName,int shardCount);
+    ~ShardedDatabaseManager();
+
+    //创建各分片的连接 分片文件名为databaseName加上分片序号，例如data.db->data_0.db,data_1.db...
+    bool createSqliteConnection(QString databaseName,SqliteConnectionOptions options=SqliteConnectionOptions());
+    void closeConnection();
+    int shardCount();
+    DatabaseManager *shard(int index);//直接操作某个分片
+    int shardOf(const QVariant &keyValue);//键值所在的分片
+
+    /*****数据定义*******/
+    //在所有分片上建表并登记分片键
+    bool createTable(QString tableName,QList<QString> &columnNames,QList<QString> &columnTypes,
+                     QString keyColumnName,QString tableConstraint=QString());
+    bool setShardKey(QString tableName,QString keyColumnName);//登记已存在的表的分片键
+    //在所有分片上配置列压缩 每个分片是独立的DatabaseManager，压缩配置不共享
+    bool setColumnCompression(QString tableName,QString columnName,ColumnCompressionOptions options=ColumnCompressionOptions());
+    bool dropTable(QString tableName);
+
+    /******数据更新*********/
+    //按分片键路由到一个分片 columnNames为空时rowValues为完整的元组数据
+    bool insertTable(QString tableName,QVariantList &rowValues,QList<QString> columnNames=QList<QString>());
+    //按分片分组后各分片并行批量插入 columnValues按列组织，同DatabaseManager::insertBatchTable()
+    bool insertBatchTable(QString tableName,QList<QVariantList> &columnValues,QList<QString> columnNames=QList<QString>());
+    //whereColName为分片键时只修改一个分片，否则在所有分片上执行
+    bool updateTable(QString tableName,QList<QString> &columnNames,QVariantList &rowValues,QString whereColName,QVariant whereColValue);
+    bool updateTable(QString tableName,QList<QString> &columnNames,QVariantList &rowValues,QString whereSql=QString());
+    bool deleteTable(QString tableName,QString whereColName,QVariant whereColValue);
+    bool deleteTable(QString tableName,QString whereSql=QString());
+
+    /******数据查询**********/
+    //单行多列 whereColName为分片键时只查询一个分片，否则返回第一个查到的分片的结果
+    QVariantList selectMultiColData(QString tableName,QList<QString> columnNames,QString whereColName,QVariant whereColValue);
+    //并行查询所有分片后合并 每个元素为一行数据，失败返回空的列表
+    QList<QVariantList> selectRows(QString tableName,QList<QString> columnNames,QString whereSql=QString());
+    QVariantList selectSingleColDatas(QString tableName,QString columnName,bool isDistinct=true,QString whereSql=QString());
+    int selectRowCount(QString tableName,QString whereSql=QString());
+    //聚合查询 function为count/sum/min/max/avg，各分片的部分结果合并为全局结果
+    QVariant selectAggregate(QString tableName,QString function,QString columnName,QString whereSql=QString());
+
+private:
+    struct ShardedTable
+    {
+        QString keyColumnName;
+        QList<QString> columnNames;//表的全部列名 插入时未指定列名则按该顺序查找分片键
+    };
+    bool findTable(const QString &tableName,ShardedTable &table);
+    int keyPosition(const QString &tableName,const QList<QString> &columnNames);
+    bool isShardKey(const QString &tableName,const QString &columnName);
+    //在所有分片上并行执行task 返回各分片的结果(按分片顺序)
+    template<typename Result>
+    QList<Result> runOnShards(std::function<Result(DatabaseManager*)> task);
+    bool execOnShards(std::function<bool(DatabaseManager*)> task);//所有分片都成功时返回true
+
+    QString connectionName;
+    QList<DatabaseManager*> shards;
+    QThreadPool threadPool;//分片查询专用的线程池 不与全局线程池中的其他任务争抢线程
+    QMutex tableMutex;
+    QHash<QString,ShardedTable> tables;//小写表名->分片信息
+};
+
+#endif // SHARDEDDATABASEMANAGER_H
@@ -0,0 +1,155 @@
+/*
+ *@file:   sqliteblobdevice.cpp
+ *@date:   2026.10.19
+ *@brief:  基于sqlite3增量blob接口的QIODevice
+ */
+#include "sqliteblobdevice.h"
+#include <QDebug>
+#ifdef SQLITE_NATIVE_API
+#include <sqlite3.h>
+#endif
+
+SqliteBlobDevice::SqliteBlobDevice(sqlite3 *handle, TableLockManager *lockManager, QString tableName,
+                                   QString columnName, qint64 rowid, QObject *parent)
+    :QIODevice(parent),handle(handle),blob(0),lockManager(lockManager),tableName(tableName),
+      columnName(columnName),rowid(rowid),blobSize(0)
+{
+}
+
+SqliteBlobDevice::~SqliteBlobDevice()
+{
+    close();
+}
+/*
+ *@brief:   打开blob 设备固定为无缓冲模式，读写直接作用于数据库，避免QIODevice
+ * 内部缓冲区的额外拷贝
+ *@date:    2026.10.19
+ *@param:   mode:ReadOnly只读 WriteOnly/ReadWrite可写
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool SqliteBlobDevice::open(OpenMode mode)
+{
+#ifdef SQLITE_NATIVE_API
+    if(blob || !handle)
+    {
+        return false;
+    }
+    int writable = (mode & QIODevice::WriteOnly) ? 1 : 0;
+    QByteArray table = tableName.toUtf8();
+    QByteArray column = columnName.toUtf8();
+    int result = sqlite3_blob_open(handle,"main",table.constData(),column.constData(),
+                                   rowid,writable,&blob);
+    if(result != SQLITE_OK)
+    {
+        setErrorString(QString::fromUtf8(sqlite3_errmsg(handle)));
+        qDebug()<<"open blob error:"<<errorString()<<tableName<<columnName<<rowid;
+        if(blob)
+        {
+            sqlite3_blob_close(blob);
+            blob = 0;
+        }
+        return false;
+    }
+    blobSize = sqlite3_blob_bytes(blob);
+    return QIODevice::open(mode | QIODevice::Unbuffered);
+#else
+    Q_UNUSED(mode);
+    setErrorString("SQLITE_NATIVE_API is not defined");
+    return false;
+#endif
+}
+
+void SqliteBlobDevice::close()
+{
+#ifdef SQLITE_NATIVE_API
+    if(blob)
+    {
+        sqlite3_blob_close(blob);
+        blob = 0;
+    }
+#endif
+    blobSize = 0;
+    QIODevice::close();
+}
+
+bool SqliteBlobDevice::isSequential() const
+{
+    return false;
+}
+
+qint64 SqliteBlobDevice::size() const
+{
+    return blobSize;
+}
+/*
+ *@brief:   从当前位置(pos())读取数据 读取时对表加读锁
+ *@date:    2026.10.19
+ *@return:  qint64:实际读取的字节数 失败返回-1
+ */
+qint64 SqliteBlobDevice::readData(char *data, qint64 maxSize)
+{
+#ifdef SQLITE_NATIVE_API
+    qint64 offset = pos();
+    qint64 readSize = qMin(maxSize,blobSize-offset);
+    if(readSize <= 0)
+    {
+        return 0;
+    }
+    int result;
+    if(lockManager)
+    {
+        TableLocker locker(lockManager,tableName,TableLocker::ReadLock);//读锁
+        result = sqlite3_blob_read(blob,data,int(readSize),int(offset));
+    }
+    else
+    {
+        result = sqlite3_blob_read(blob,data,int(readSize),int(offset));
+    }
+    if(result != SQLITE_OK)
+    {
+        setErrorString(QString::fromUtf8(sqlite3_errstr(result)));
+        return -1;
+    }
+    return readSize;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+#endif
+}
+/*
+ *@brief:   从当前位置(pos())写入数据 写入时对表加写锁，不能超出blob的长度
+ *@date:    2026.10.19
+ *@return:  qint64:实际写入的字节数 失败返回-1
+ */
+qint64 SqliteBlobDevice::writeData(const char *data, qint64 maxSize)
+{
+#ifdef SQLITE_NATIVE_API
+    qint64 offset = pos();
+    if(offset+maxSize > blobSize)
+    {
+        setErrorString("write beyond the blob size, reserve space with resizeBlob() first");
+        return -1;
+    }
+    int result;
+    if(lockManager)
+    {
+        TableLocker locker(lockManager,tableName,TableLocker::WriteLock);//写锁
+        result = sqlite3_blob_write(blob,data,int(maxSize),int(offset));
+    }
+    else
+    {
+        result = sqlite3_blob_write(blob,data,int(maxSize),int(offset));
+    }
+    if(result != SQLITE_OK)
+    {
+        setErrorString(QString::fromUtf8(sqlite3_errstr(result)));
+        return -1;
+    }
+    return maxSize;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+#endif
+}
@@ -0,0 +1,56 @@
+/*
+ *@file:   sqliteblobdevice.h
+ *@date:   2026.10.19
+ *@brief:  基于sqlite3增量blob接口(sqlite3_blob_open/read/write)的QIODevice
+ * 数兆字节的BLOB数据通过普通接口读写时，需要把整个值放进QVariant/QByteArray并拷贝多次。
+ * 该设备直接在数据库文件中按偏移读写指定行的BLOB字段，可以分块流式处理，内存占用只
+ * 取决于每次读写的缓冲区大小。
+ *
+ * 注:1.增量blob接口不能改变BLOB的长度，写入前需要先通过DatabaseManager::resizeBlob()
+ *      (zeroblob)预留好空间，写入超出长度的部分会失败。
+ *    2.设备打开期间，如果该行被其他语句修改或删除，设备会失效，后续读写返回-1。
+ *    3.设备必须在数据库连接关闭之前关闭或析构，否则连接无法正常关闭。
+ *    4.以可写方式打开的设备在关闭前一直占用共享连接上的写事务:其他连接(进程)的写入会得到
+ *      SQLITE_BUSY，同一DatabaseManager上其他线程的事务(如insertBatchTable())提交时可能
+ *      因"SQL statements in progress"失败。可写设备应尽快写完并立即关闭，不要长期持有；
+ *      只读设备同样占用读事务，会阻止WAL检查点的完成。
+ *    5.需要定义SQLITE_NATIVE_API(见DatabaseManager.pro)。
+ */
+#ifndef SQLITEBLOBDEVICE_H
+#define SQLITEBLOBDEVICE_H
+
+#include <QIODevice>
+#include <QString>
+#include "tablelockmanager.h"
+
+struct sqlite3;
+struct sqlite3_blob;
+
+class SqliteBlobDevice : public QIODevice
+{
+    Q_OBJECT
+public:
+    SqliteBlobDevice(sqlite3 *handle,TableLockManager *lockManager,QString tableName,
+                     QString columnName,qint64 rowid,QObject *parent = 0);
+    ~SqliteBlobDevice();
+
+    bool open(OpenMode mode);
+    void close();
+    bool isSequential() const;
+    qint64 size() const;
+
+protected:
+    qint64 readData(char *data,qint64 maxSize);
+    qint64 writeData(const char *data,qint64 maxSize);
+
+private:
+    sqlite3 *handle;//数据库连接句柄
+    sqlite3_blob *blob;//增量blob句柄
+    TableLockManager *lockManager;//读写时对表加锁，可以为0
+    QString tableName;
+    QString columnName;
+    qint64 rowid;
+    qint64 blobSize;
+};
+
+#endif // SQLITEBLOBDEVICE_H
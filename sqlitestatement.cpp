@@ -0,0 +1,348 @@
+/*
+ *@file:   sqlitestatement.cpp
+ *@date:   2026.10.19
+ *@brief:  sqlite3原生语句(sqlite3_stmt)的封装及预处理语句缓存
+ */
+#include "sqlitestatement.h"
+#ifdef SQLITE_NATIVE_API
+#include <QMutexLocker>
+#include <sqlite3.h>
+
+SqliteStatementCache::PreparedStatement::~PreparedStatement()
+{
+    sqlite3_finalize(stmt);
+}
+
+SqliteStatementCache::SqliteStatementCache(int capacity)
+    :connectionHandle(0),statements(capacity)
+{
+}
+
+SqliteStatementCache::~SqliteStatementCache()
+{
+    clear();
+}
+/*
+ *@brief:   设置连接句柄 原连接缓存的语句会被全部释放
+ *@date:    2026.10.19
+ *@param:   handle:sqlite3连接句柄，0表示不使用原生接口
+ */
+void SqliteStatementCache::setHandle(sqlite3 *handle)
+{
+    QMutexLocker locker(&mutex);
+    statements.clear();
+    connectionHandle = handle;
+}
+
+sqlite3 *SqliteStatementCache::handle()
+{
+    QMutexLocker locker(&mutex);
+    return connectionHandle;
+}
+/*
+ *@brief:   取出sql对应的空闲语句，缓存中没有时新预处理一条
+ * 取出的语句归调用者独占，使用完毕后通过release()放回
+ *@date:    2026.10.19
+ *@param:   sql:sql语句
+ *@param:   errorMessage:预处理失败时的错误信息
+ *@return:  sqlite3_stmt*:预处理好的语句，失败返回0
+ */
+sqlite3_stmt *SqliteStatementCache::acquire(const QString &sql, QString *errorMessage)
+{
+    sqlite3 *handle;
+    {
+        QMutexLocker locker(&mutex);
+        PreparedStatement *prepared = statements.take(sql);
+        if(prepared)
+        {
+            sqlite3_stmt *stmt = prepared->stmt;
+            prepared->stmt = 0;
+            delete prepared;
+            return stmt;
+        }
+        handle = connectionHandle;
+    }
+    if(!handle)
+    {
+        *errorMessage = "sqlite3 handle is not available";
+        return 0;
+    }
+    //预处理不需要持有缓存的锁，sqlite在串行模式下内部会加锁
+    sqlite3_stmt *stmt = 0;
+    QByteArray sqlUtf8 = sql.toUtf8();
+    int result = sqlite3_prepare_v2(handle,sqlUtf8.constData(),sqlUtf8.size(),&stmt,0);
+    if(result != SQLITE_OK)
+    {
+        *errorMessage = QString::fromUtf8(sqlite3_errmsg(handle));
+        sqlite3_finalize(stmt);
+        return 0;
+    }
+    return stmt;
+}
+/*
+ *@brief:   重置语句并放回缓存 缓存已满时淘汰最久未使用的语句，同一sql已有
+ * 空闲语句时替换掉旧的
+ *@date:    2026.10.19
+ */
+void SqliteStatementCache::release(const QString &sql, sqlite3_stmt *stmt)
+{
+    if(!stmt)
+    {
+        return;
+    }
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    QMutexLocker locker(&mutex);
+    //连接已切换(或关闭)，语句不能再放回缓存
+    if(!connectionHandle || sqlite3_db_handle(stmt) != connectionHandle)
+    {
+        sqlite3_finalize(stmt);
+        return;
+    }
+    statements.insert(sql,new PreparedStatement(stmt));
+}
+
+void SqliteStatementCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    statements.clear();
+}
+
+SqliteStatement::SqliteStatement(SqliteStatementCache *cache, const QString &sql)
+    :cache(cache),sql(sql),stmt(0),isError(false)
+{
+    stmt = cache->acquire(sql,&errorMessage);
+    isError = (stmt == 0);
+}
+
+SqliteStatement::~SqliteStatement()
+{
+    cache->release(sql,stmt);
+}
+
+bool SqliteStatement::isValid() const
+{
+    return stmt != 0;
+}
+
+QString SqliteStatement::lastError() const
+{
+    return errorMessage;
+}
+/*
+ *@brief:   按QVariant的类型绑定参数
+ *@date:    2026.10.19
+ *@param:   index:参数下标 从0开始
+ *@param:   value:参数值
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool SqliteStatement::bindValue(int index, const QVariant &value)
+{
+    if(value.isNull())
+    {
+        return bindNull(index);
+    }
+    switch(int(value.type()))
+    {
+    case QVariant::Int:
+    case QVariant::UInt:
+    case QVariant::LongLong:
+    case QVariant::ULongLong:
+    case QVariant::Bool:
+        return bindInt64(index,value.toLongLong());
+    case QVariant::Double:
+        return bindDouble(index,value.toDouble());
+    case QVariant::ByteArray:
+        return bindBlob(index,value.toByteArray());
+    default:
+        return bindText(index,value.toString());
+    }
+}
+
+bool SqliteStatement::bindValues(const QVariantList &values)
+{
+    for(int i=0;i<values.size();i++)
+    {
+        if(!bindValue(i,values.at(i)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SqliteStatement::bindNull(int index)
+{
+    return checkBind(sqlite3_bind_null(stmt,index+1));
+}
+
+bool SqliteStatement::bindInt64(int index, qint64 value)
+{
+    return checkBind(sqlite3_bind_int64(stmt,index+1,value));
+}
+
+bool SqliteStatement::bindDouble(int index, double value)
+{
+    return checkBind(sqlite3_bind_double(stmt,index+1,value));
+}
+
+bool SqliteStatement::bindText(int index, const QString &value)
+{
+    return checkBind(sqlite3_bind_text16(stmt,index+1,value.utf16(),value.size()*int(sizeof(QChar)),
+                                         SQLITE_TRANSIENT));
+}
+
+bool SqliteStatement::bindBlob(int index, const QByteArray &value)
+{
+    return checkBind(sqlite3_bind_blob(stmt,index+1,value.constData(),value.size(),SQLITE_TRANSIENT));
+}
+/*
+ *@brief:   执行语句直到结束，然后重置语句(释放语句持有的读写锁)
+ *@date:    2026.10.19
+ *@param:   changes:不为空时返回本条语句影响的行数。sqlite3_changes()记录的是连接上最近
+ * 一条语句，这里在连接的互斥锁内与执行一起读取，避免读到其他线程的语句
+ *@return:  返回值为布尔类型，true:成功，false:失败
+ */
+bool SqliteStatement::exec(int *changes)
+{
+    if(changes)
+    {
+        *changes = 0;
+    }
+    if(!stmt)
+    {
+        return false;
+    }
+    sqlite3 *handle = sqlite3_db_handle(stmt);
+    sqlite3_mutex_enter(sqlite3_db_mutex(handle));//串行模式下为递归锁，非串行模式下为空操作
+    while(next())
+    {
+    }
+    if(changes && !isError)
+    {
+        *changes = sqlite3_changes(handle);
+    }
+    sqlite3_mutex_leave(sqlite3_db_mutex(handle));
+    sqlite3_reset(stmt);
+    return !isError;
+}
+/*
+ *@brief:   执行一步
+ *@date:    2026.10.19
+ *@return:  bool:true=得到一条结果行 false=执行结束或出错
+ */
+bool SqliteStatement::next()
+{
+    if(!stmt)
+    {
+        return false;
+    }
+    int result = sqlite3_step(stmt);
+    if(result == SQLITE_ROW)
+    {
+        return true;
+    }
+    if(result != SQLITE_DONE)
+    {
+        isError = true;
+        errorMessage = QString::fromUtf8(sqlite3_errmsg(sqlite3_db_handle(stmt)));
+    }
+    return false;
+}
+
+bool SqliteStatement::hasError() const
+{
+    return isError;
+}
+
+void SqliteStatement::reset()
+{
+    if(stmt)
+    {
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    isError = false;
+    errorMessage.clear();
+}
+
+int SqliteStatement::columnCount() const
+{
+    return stmt ? sqlite3_column_count(stmt) : 0;
+}
+/*
+ *@brief:   读取当前结果行某一列的值 与QSQLITE驱动一致，整型为qlonglong
+ *@date:    2026.10.19
+ *@param:   column:列下标 从0开始
+ *@return:  QVariant:列值 NULL返回无效的QVariant
+ */
+QVariant SqliteStatement::value(int column) const
+{
+    switch(sqlite3_column_type(stmt,column))
+    {
+    case SQLITE_INTEGER:
+        return QVariant(qlonglong(sqlite3_column_int64(stmt,column)));
+    case SQLITE_FLOAT:
+        return QVariant(sqlite3_column_double(stmt,column));
+    case SQLITE_TEXT:
+    {
+        const QChar *text = static_cast<const QChar *>(sqlite3_column_text16(stmt,column));
+        return QVariant(QString(text,sqlite3_column_bytes16(stmt,column)/int(sizeof(QChar))));
+    }
+    case SQLITE_BLOB:
+    {
+        const char *data = static_cast<const char *>(sqlite3_column_blob(stmt,column));
+        return QVariant(QByteArray(data,sqlite3_column_bytes(stmt,column)));
+    }
+    default:
+        return QVariant();
+    }
+}
+/*
+ *@brief:   将当前结果行按原生类型追加到内存池结果集，不经过QVariant
+ *@date:    2026.10.19
+ */
+void SqliteStatement::appendRowTo(ArenaResultSet &resultSet) const
+{
+    int count = sqlite3_column_count(stmt);
+    for(int i=0;i<count;i++)
+    {
+        switch(sqlite3_column_type(stmt,i))
+        {
+        case SQLITE_INTEGER:
+            resultSet.appendInt64(sqlite3_column_int64(stmt,i));
+            break;
+        case SQLITE_FLOAT:
+            resultSet.appendDouble(sqlite3_column_double(stmt,i));
+            break;
+        case SQLITE_TEXT:
+        {
+            const QChar *text = static_cast<const QChar *>(sqlite3_column_text16(stmt,i));
+            resultSet.appendText(text,sqlite3_column_bytes16(stmt,i)/int(sizeof(QChar)));
+            break;
+        }
+        case SQLITE_BLOB:
+        {
+            const char *data = static_cast<const char *>(sqlite3_column_blob(stmt,i));
+            resultSet.appendBlob(data,sqlite3_column_bytes(stmt,i));
+            break;
+        }
+        default:
+            resultSet.appendNull();
+            break;
+        }
+    }
+}
+
+bool SqliteStatement::checkBind(int result)
+{
+    if(result != SQLITE_OK)
+    {
+        isError = true;
+        errorMessage = QString::fromUtf8(sqlite3_errstr(result));
+        return false;
+    }
+    return true;
+}
+
+#endif // SQLITE_NATIVE_API
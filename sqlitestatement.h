@@ -0,0 +1,96 @@
+/*
+ *@file:   sqlitestatement.h
+ *@date:   2026.10.19
+ *@brief:  sqlite3原生语句(sqlite3_stmt)的封装及预处理语句缓存
+ * 性能分析发现，每次调用的大部分耗时在Qt SQL的封装层(QSqlQuery、QSqlResult、QVariant转换)
+ * 而不是sqlite本身。DatabaseManager在SQLITE_NATIVE_API可用时，通过db.driver()->handle()
+ * 获取sqlite3连接句柄，直接使用sqlite3_stmt执行语句，并按sql文本缓存预处理好的语句，
+ * 相同的sql再次执行时省去解析和预处理的开销。
+ *
+ * SqliteStatementCache:预处理语句缓存(LRU)，多线程共用，内部加锁。语句在使用期间从
+ *   缓存中取出，使用完毕后放回，所以不同线程不会同时使用同一个sqlite3_stmt。
+ * SqliteStatement:从缓存中取出(或新预处理)一条语句，析构时重置并放回缓存。
+ *
+ * 注:1.只有定义了SQLITE_NATIVE_API时才会编译该组件的实现。
+ *    2.连接句柄只有在驱动的sqlite_source_id()与本程序链接的sqlite3_sourceid()一致时才会
+ *      使用(见DatabaseManager::sqliteHandle())，否则原生路径不启用，execSql()等仍通过
+ *      QSqlQuery执行。也可以调用setNativeApiEnabled(false)手动关闭。
+ */
+#ifndef SQLITESTATEMENT_H
+#define SQLITESTATEMENT_H
+
+#include <QString>
+#include <QVariant>
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include "arenaresultset.h"
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+class SqliteStatementCache
+{
+public:
+    explicit SqliteStatementCache(int capacity = 64);
+    ~SqliteStatementCache();
+
+    void setHandle(sqlite3 *handle);//设置连接句柄，切换连接时会清空缓存
+    sqlite3 *handle();
+    sqlite3_stmt *acquire(const QString &sql,QString *errorMessage);//取出或预处理语句
+    void release(const QString &sql,sqlite3_stmt *stmt);//重置语句并放回缓存
+    void clear();//释放所有缓存的语句 关闭连接前必须调用
+
+private:
+    //QCache淘汰或删除对象时会析构，析构时释放语句
+    struct PreparedStatement
+    {
+        explicit PreparedStatement(sqlite3_stmt *stmt):stmt(stmt){}
+        ~PreparedStatement();
+        sqlite3_stmt *stmt;
+    };
+    QMutex mutex;
+    sqlite3 *connectionHandle;
+    QCache<QString,PreparedStatement> statements;//sql->空闲的预处理语句
+};
+
+class SqliteStatement
+{
+public:
+    SqliteStatement(SqliteStatementCache *cache,const QString &sql);
+    ~SqliteStatement();
+
+    bool isValid() const;//语句是否预处理成功
+    QString lastError() const;
+
+    //绑定参数 index从0开始
+    bool bindValue(int index,const QVariant &value);
+    bool bindValues(const QVariantList &values);
+    bool bindNull(int index);
+    bool bindInt64(int index,qint64 value);
+    bool bindDouble(int index,double value);
+    bool bindText(int index,const QString &value);
+    bool bindBlob(int index,const QByteArray &value);
+
+    bool exec(int *changes = 0);//执行到结束并重置语句，之后可以重新绑定参数再次执行
+    bool next();//执行一步，有结果行返回true，结束或出错返回false(用hasError()区分)
+    bool hasError() const;
+    void reset();//重置语句并清除绑定的参数
+
+    //读取当前结果行
+    int columnCount() const;
+    QVariant value(int column) const;
+    void appendRowTo(ArenaResultSet &resultSet) const;//按原生类型追加到内存池结果集
+
+private:
+    Q_DISABLE_COPY(SqliteStatement)
+    bool checkBind(int result);
+
+    SqliteStatementCache *cache;
+    QString sql;
+    sqlite3_stmt *stmt;
+    bool isError;
+    QString errorMessage;
+};
+
+#endif // SQLITESTATEMENT_H
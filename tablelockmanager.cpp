@@ -0,0 +1,262 @@
+/*
+ *@file:   tablelockmanager.cpp
+ *@date:   2026.10.19
+ *@brief:  按表名管理读写锁的锁管理器
+ */
+#include "tablelockmanager.h"
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QThread>
+
+TableLockManager::TableLockManager()
+    :databaseLock(QReadWriteLock::Recursive),exclusiveOwner(0),exclusiveDepth(0)
+{
+}
+
+TableLockManager::~TableLockManager()
+{
+    qDeleteAll(tableLocks);
+    tableLocks.clear();
+}
+/*
+ *@brief:   对多个表加锁
+ * 先对数据库锁加读锁，再按表名顺序依次对各表加锁。读锁和写锁都是可重入的，
+ * 但同一线程不能先加读锁再加写锁，所以同一表名同时需要读写时直接加写锁。
+ *@date:    2026.10.19
+ *@param:   readTables:需要加读锁的表
+ *@param:   writeTables:需要加写锁的表
+ */
+void TableLockManager::lockTables(const QStringList &readTables, const QStringList &writeTables)
+{
+    //当前线程已持有独占锁，表锁没有意义，也避免写锁后加读锁锁死
+    if(isDatabaseLockedByCurrentThread())
+    {
+        return;
+    }
+    if(databaseLock.tryLockForRead())
+    {
+        recordAcquire(DATABASE_LOCK_NAME,false,0);
+    }
+    else
+    {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        databaseLock.lockForRead();
+        recordAcquire(DATABASE_LOCK_NAME,true,waitTimer.elapsed());
+    }
+    //QMap按键(表名)排序，保证多表加锁的顺序固定
+    QMap<QString,bool> tables = mergeTables(readTables,writeTables);
+    QMap<QString,bool>::const_iterator it = tables.constBegin();
+    for(;it != tables.constEnd();++it)
+    {
+        QReadWriteLock *lock = tableLock(it.key());
+        bool isWrite = it.value();
+        if(isWrite ? lock->tryLockForWrite() : lock->tryLockForRead())
+        {
+            recordAcquire(it.key(),false,0);
+            continue;
+        }
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        if(isWrite)
+        {
+            lock->lockForWrite();
+        }
+        else
+        {
+            lock->lockForRead();
+        }
+        recordAcquire(it.key(),true,waitTimer.elapsed());
+    }
+}
+/*
+ *@brief:   对多个表解锁 参数需与lockTables()一致
+ *@date:    2026.10.19
+ *@param:   readTables:已加读锁的表
+ *@param:   writeTables:已加写锁的表
+ */
+void TableLockManager::unlockTables(const QStringList &readTables, const QStringList &writeTables)
+{
+    if(isDatabaseLockedByCurrentThread())
+    {
+        return;
+    }
+    //按加锁的相反顺序解锁
+    QMap<QString,bool> tables = mergeTables(readTables,writeTables);
+    QMap<QString,bool>::const_iterator it = tables.constEnd();
+    while(it != tables.constBegin())
+    {
+        --it;
+        tableLock(it.key())->unlock();
+    }
+    databaseLock.unlock();
+}
+/*
+ *@brief:   加数据库独占锁 可重入
+ *@date:    2026.10.19
+ */
+void TableLockManager::lockDatabase()
+{
+    if(isDatabaseLockedByCurrentThread())
+    {
+        exclusiveDepth++;
+        return;
+    }
+    if(databaseLock.tryLockForWrite())
+    {
+        recordAcquire(DATABASE_LOCK_NAME,false,0);
+    }
+    else
+    {
+        QElapsedTimer waitTimer;
+        waitTimer.start();
+        databaseLock.lockForWrite();
+        recordAcquire(DATABASE_LOCK_NAME,true,waitTimer.elapsed());
+    }
+    exclusiveOwner.storeRelease(QThread::currentThreadId());
+    exclusiveDepth = 1;
+}
+/*
+ *@brief:   解数据库独占锁
+ *@date:    2026.10.19
+ */
+void TableLockManager::unlockDatabase()
+{
+    if(--exclusiveDepth > 0)
+    {
+        return;
+    }
+    exclusiveOwner.storeRelease(0);
+    databaseLock.unlock();
+}
+/*
+ *@brief:   当前线程是否持有数据库独占锁
+ *@date:    2026.10.19
+ *@return:  bool:true=持有　false=未持有
+ */
+bool TableLockManager::isDatabaseLockedByCurrentThread()
+{
+    return exclusiveOwner.loadAcquire() == QThread::currentThreadId();
+}
+/*
+ *@brief:   获取锁竞争统计信息
+ *@date:    2026.10.19
+ *@param:   reset:获取后是否清空统计
+ *@return:  QHash<QString,TableLockStats>:表名(小写)->统计信息
+ */
+QHash<QString,TableLockStats> TableLockManager::statistics(bool reset)
+{
+    QMutexLocker locker(&mutex);
+    QHash<QString,TableLockStats> stats = lockStats;
+    if(reset)
+    {
+        lockStats.clear();
+    }
+    return stats;
+}
+/*
+ *@brief:   表锁的名称 sqlite表名不区分大小写，统一转为小写；"main.表名"与"表名"是同一个表，
+ * 去掉main前缀，保证两种写法加的是同一把锁
+ *@date:    2026.10.19
+ *@param:   tableName:表名
+ *@return:  QString:锁名
+ */
+static QString normalizedLockName(const QString &tableName)
+{
+    QString name = tableName.toLower();
+    if(name.startsWith("main."))
+    {
+        name.remove(0,5);
+    }
+    return name;
+}
+/*
+ *@brief:   合并读表和写表 表名按normalizedLockName()统一
+ *@date:    2026.10.19
+ *@return:  QMap<QString,bool>:表名->是否加写锁
+ */
+QMap<QString,bool> TableLockManager::mergeTables(const QStringList &readTables, const QStringList &writeTables)
+{
+    QMap<QString,bool> tables;
+    for(int i=0;i<readTables.size();i++)
+    {
+        QString name = normalizedLockName(readTables.at(i));
+        if(!tables.contains(name))
+        {
+            tables.insert(name,false);
+        }
+    }
+    for(int i=0;i<writeTables.size();i++)
+    {
+        tables.insert(normalizedLockName(writeTables.at(i)),true);
+    }
+    return tables;
+}
+/*
+ *@brief:   获取表锁 不存在则创建 表锁创建后一直保留到管理器析构
+ *@date:    2026.10.19
+ *@param:   tableName:表名(小写)
+ *@return:  QReadWriteLock*:表锁
+ */
+QReadWriteLock *TableLockManager::tableLock(const QString &tableName)
+{
+    QMutexLocker locker(&mutex);
+    QReadWriteLock *lock = tableLocks.value(tableName,0);
+    if(!lock)
+    {
+        lock = new QReadWriteLock(QReadWriteLock::Recursive);
+        tableLocks.insert(tableName,lock);
+    }
+    return lock;
+}
+/*
+ *@brief:   记录一次加锁
+ *@date:    2026.10.19
+ */
+void TableLockManager::recordAcquire(const QString &lockName, bool contended, qint64 waitMsecs)
+{
+    QMutexLocker locker(&mutex);
+    TableLockStats &stats = lockStats[lockName];
+    stats.acquisitions++;
+    if(contended)
+    {
+        stats.contentions++;
+        stats.waitMsecs += waitMsecs;
+    }
+}
+
+TableLocker::TableLocker(TableLockManager *manager, const QString &tableName, LockMode mode)
+    :manager(manager)
+{
+    if(mode == WriteLock)
+    {
+        writeTables<<tableName;
+    }
+    else
+    {
+        readTables<<tableName;
+    }
+    manager->lockTables(readTables,writeTables);
+}
+
+TableLocker::TableLocker(TableLockManager *manager, const QStringList &readTables, const QStringList &writeTables)
+    :manager(manager),readTables(readTables),writeTables(writeTables)
+{
+    manager->lockTables(readTables,writeTables);
+}
+
+TableLocker::~TableLocker()
+{
+    manager->unlockTables(readTables,writeTables);
+}
+
+DatabaseLocker::DatabaseLocker(TableLockManager *manager)
+    :manager(manager)
+{
+    manager->lockDatabase();
+}
+
+DatabaseLocker::~DatabaseLocker()
+{
+    manager->unlockDatabase();
+}
@@ -0,0 +1,97 @@
+/*
+ *@file:   tablelockmanager.h
+ *@date:   2026.10.19
+ *@brief:  按表名管理读写锁的锁管理器，供DatabaseManager在MT_SAFE下使用。
+ * 原先所有表共用一个全局读写锁，对A表的长时间copyTable会阻塞对B表的普通读取。
+ * 该管理器为每个表名维护一个独立的读写锁，各操作只锁自己涉及的表：
+ * 1.普通的表操作先对数据库锁加读锁(共享)，再对涉及的表按表名顺序加锁，多表加锁
+ *   (如copyTable的源表和目的表)总是按固定顺序进行，避免交叉加锁造成死锁。
+ * 2.表名未知的原生sql语句、附加/分离数据库等操作需要升级为数据库独占锁(对数据库锁
+ *   加写锁)，此时所有的表操作都会被阻塞。持有独占锁的线程再对表加锁时直接跳过，
+ *   这样独占操作内部可以调用其他加表锁的接口而不会死锁。
+ * 注:持有表锁的线程不能再升级为独占锁(读锁不能升级为写锁)，否则会锁死。
+ */
+#ifndef TABLELOCKMANAGER_H
+#define TABLELOCKMANAGER_H
+
+#include <QReadWriteLock>
+#include <QMutex>
+#include <QAtomicPointer>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+//数据库独占锁在统计信息中使用的名字
+#define DATABASE_LOCK_NAME "*"
+
+//单个表(或数据库独占锁)的锁竞争统计
+struct TableLockStats
+{
+    TableLockStats():acquisitions(0),contentions(0),waitMsecs(0){}
+    qint64 acquisitions;//加锁次数
+    qint64 contentions;//加锁时发生等待的次数
+    qint64 waitMsecs;//等待锁的累计时间(ms)
+};
+
+class TableLockManager
+{
+public:
+    TableLockManager();
+    ~TableLockManager();
+
+    //对表加锁/解锁 同一表名同时出现在读表和写表中时按写锁处理
+    void lockTables(const QStringList &readTables,const QStringList &writeTables);
+    void unlockTables(const QStringList &readTables,const QStringList &writeTables);
+    //数据库独占锁(升级锁) 用于DDL、原生sql及附加数据库等操作
+    void lockDatabase();
+    void unlockDatabase();
+    bool isDatabaseLockedByCurrentThread();
+
+    //锁竞争统计 键为小写表名，数据库独占锁的键为DATABASE_LOCK_NAME
+    QHash<QString,TableLockStats> statistics(bool reset=false);
+
+private:
+    QMap<QString,bool> mergeTables(const QStringList &readTables,const QStringList &writeTables);
+    QReadWriteLock *tableLock(const QString &tableName);
+    void recordAcquire(const QString &lockName,bool contended,qint64 waitMsecs);
+
+    QMutex mutex;//保护tableLocks和lockStats
+    QHash<QString,QReadWriteLock *> tableLocks;//表名(小写)->表锁
+    QHash<QString,TableLockStats> lockStats;
+    QReadWriteLock databaseLock;//数据库锁 表操作加读锁，独占操作加写锁
+    QAtomicPointer<void> exclusiveOwner;//持有独占锁的线程id
+    int exclusiveDepth;//独占锁的重入次数，只由持有者线程访问
+};
+
+/*表锁的RAII封装，构造时加锁，析构时解锁，用法同QReadLocker/QWriteLocker*/
+class TableLocker
+{
+public:
+    enum LockMode
+    {
+        ReadLock,
+        WriteLock
+    };
+    TableLocker(TableLockManager *manager,const QString &tableName,LockMode mode);
+    TableLocker(TableLockManager *manager,const QStringList &readTables,const QStringList &writeTables);
+    ~TableLocker();
+
+private:
+    TableLockManager *manager;
+    QStringList readTables;
+    QStringList writeTables;
+};
+
+/*数据库独占锁的RAII封装*/
+class DatabaseLocker
+{
+public:
+    explicit DatabaseLocker(TableLockManager *manager);
+    ~DatabaseLocker();
+
+private:
+    TableLockManager *manager;
+};
+
+#endif // TABLELOCKMANAGER_H
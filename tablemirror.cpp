@@ -0,0 +1,94 @@
+/*
+ *@file:   tablemirror.cpp
+ *@date:   2026.10.19
+ *@brief:  常驻内存的表镜像
+ */
+#include "tablemirror.h"
+
+TableMirror::TableMirror(const QStringList &columnNames, const QString &keyColumnName)
+    :columnNames(columnNames),keyIndex(-1)
+{
+    for(int i=0;i<columnNames.size();i++)
+    {
+        columnIndexes.insert(columnNames.at(i).toLower(),i);
+    }
+    keyIndex = columnIndexes.value(keyColumnName.toLower(),-1);
+}
+
+bool TableMirror::isValid() const
+{
+    return keyIndex >= 0;
+}
+
+QString TableMirror::keyColumnName() const
+{
+    return isValid() ? columnNames.at(keyIndex) : QString();
+}
+
+QStringList TableMirror::columns() const
+{
+    return columnNames;
+}
+
+int TableMirror::columnIndex(const QString &columnName) const
+{
+    return columnIndexes.value(columnName.trimmed().toLower(),-1);
+}
+
+int TableMirror::rowCount() const
+{
+    QReadLocker locker(&lock);
+    return rows.size();
+}
+/*
+ *@brief:   查询键值对应行的数据
+ *@date:    2026.10.19
+ *@param:   keyValue:键值
+ *@param:   columns:列的下标 为空表示整行
+ *@param:   values:返回的列数据
+ *@return:  bool:true=该行存在 false=不存在
+ */
+bool TableMirror::select(const QVariant &keyValue, const QList<int> &columns, QVariantList &values) const
+{
+    QReadLocker locker(&lock);
+    QHash<QString,QVariantList>::const_iterator it = rows.constFind(keyValue.toString());
+    if(it == rows.constEnd())
+    {
+        return false;
+    }
+    if(columns.isEmpty())
+    {
+        values = it.value();
+        return true;
+    }
+    for(int i=0;i<columns.size();i++)
+    {
+        values.append(it.value().at(columns.at(i)));
+    }
+    return true;
+}
+
+void TableMirror::setRows(const QVariantList &values)
+{
+    int columnCount = columnNames.size();
+    QHash<QString,QVariantList> newRows;
+    newRows.reserve(columnCount ? values.size()/columnCount : 0);
+    for(int row=0;columnCount && row+columnCount<=values.size();row+=columnCount)
+    {
+        newRows.insert(values.at(row+keyIndex).toString(),values.mid(row,columnCount));
+    }
+    QWriteLocker locker(&lock);
+    rows.swap(newRows);
+}
+
+void TableMirror::setRow(const QVariant &keyValue, const QVariantList &rowValues)
+{
+    QWriteLocker locker(&lock);
+    rows.insert(keyValue.toString(),rowValues);
+}
+
+void TableMirror::removeRow(const QVariant &keyValue)
+{
+    QWriteLocker locker(&lock);
+    rows.remove(keyValue.toString());
+}
@@ -0,0 +1,48 @@
+/*
+ *@file:   tablemirror.h
+ *@date:   2026.10.19
+ *@brief:  常驻内存的表镜像
+ * 配置表、查找表这类读多写少的表，每秒通过selectSingleColData()查询成千上万次。
+ * DatabaseManager::pinTable()把这样的表整体加载到内存中的镜像，按主键(键值列)查询时
+ * 直接从镜像返回，不执行sql，也不需要加表锁，与磁盘表的写操作没有锁竞争；对该表的每次
+ * 写操作在写入磁盘后(仍持有表写锁时)同步更新镜像，键值条件的写操作只重新读取受影响的行，
+ * 其他写操作重新加载整个表。
+ *
+ * 镜像自身使用一个读写锁，只在更新镜像的瞬间阻塞读取。
+ */
+#ifndef TABLEMIRROR_H
+#define TABLEMIRROR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QHash>
+#include <QReadWriteLock>
+
+class TableMirror
+{
+public:
+    TableMirror(const QStringList &columnNames,const QString &keyColumnName);
+
+    bool isValid() const;//键值列是否存在
+    QString keyColumnName() const;
+    QStringList columns() const;//镜像的列名 与数据表的列顺序一致
+    int columnIndex(const QString &columnName) const;//列名(不区分大小写)对应的下标 不存在返回-1
+    int rowCount() const;
+
+    //查询键值对应行的指定列 columns为空表示整行，返回false表示该行不存在
+    bool select(const QVariant &keyValue,const QList<int> &columns,QVariantList &values) const;
+    //更新镜像数据
+    void setRows(const QVariantList &values);//整表替换 values按行依次展开
+    void setRow(const QVariant &keyValue,const QVariantList &rowValues);
+    void removeRow(const QVariant &keyValue);
+
+private:
+    mutable QReadWriteLock lock;
+    QStringList columnNames;
+    QHash<QString,int> columnIndexes;//小写列名->下标
+    int keyIndex;//键值列的下标
+    QHash<QString,QVariantList> rows;//键值(字符串形式)->整行数据
+};
+
+#endif // TABLEMIRROR_H
@@ -0,0 +1,113 @@
+/*
+ *@file:   tablepager.cpp
+ *@date:   2026.10.19
+ *@brief:  大表的分页浏览
+ */
+#include "tablepager.h"
+#include <QtConcurrent/QtConcurrentRun>
+
+TablePager::TablePager(DatabaseManager *databaseManager, QString tableName, QList<QString> columnNames,
+                       QString orderColumnName, int pageSize, QString whereSql, bool isDescending)
+    :databaseManager(databaseManager),tableName(tableName),columnNames(columnNames),orderColumnName(orderColumnName),
+      pageSize(pageSize),whereSql(whereSql),isDescending(isDescending),isPrefetchEnabled(false),isFinished(false),
+      isPrefetching(false)
+{
+}
+
+TablePager::~TablePager()
+{
+    cancelPrefetch();
+}
+
+void TablePager::setPrefetchEnabled(bool enabled)
+{
+    isPrefetchEnabled = enabled;
+    if(!enabled)
+    {
+        cancelPrefetch();
+    }
+}
+
+bool TablePager::hasMore()
+{
+    return !isFinished;
+}
+
+QVariant TablePager::cursor()
+{
+    return nextKey;
+}
+
+void TablePager::seek(QVariant afterKey)
+{
+    cancelPrefetch();
+    nextKey = afterKey;
+    isFinished = false;
+}
+
+void TablePager::reset()
+{
+    seek(QVariant());
+}
+/*
+ *@brief:   查询下一页 已预取当前游标的页时直接使用预取的结果，之后开始预取再下一页
+ *@date:    2026.10.19
+ *@return:  QList<QVariantList>:该页的数据 每个元素为一行
+ */
+QList<QVariantList> TablePager::nextPage()
+{
+    if(isFinished)
+    {
+        return QList<QVariantList>();
+    }
+    Page page;
+    if(isPrefetching)
+    {
+        page = prefetchFuture.result();
+        isPrefetching = false;
+    }
+    //预取失败或游标已改变时重新查询
+    if(!page.isSuccess || page.afterKey != nextKey)
+    {
+        page = fetchPage(nextKey);
+    }
+    if(!page.isSuccess)
+    {
+        return QList<QVariantList>();
+    }
+    nextKey = page.nextKey;
+    isFinished = !nextKey.isValid();
+    startPrefetch();
+    return page.rows;
+}
+
+TablePager::Page TablePager::fetchPage(const QVariant &afterKey)
+{
+    Page page;
+    page.afterKey = afterKey;
+    page.isSuccess = databaseManager->selectPage(page.rows,page.nextKey,tableName,columnNames,orderColumnName,
+                                                 afterKey,pageSize,whereSql,isDescending);
+    return page;
+}
+
+void TablePager::startPrefetch()
+{
+    if(!isPrefetchEnabled || isFinished)
+    {
+        return;
+    }
+    QVariant afterKey = nextKey;
+    prefetchFuture = QtConcurrent::run([this,afterKey](){
+        return fetchPage(afterKey);
+    });
+    isPrefetching = true;
+}
+//丢弃预取的页 需要等待正在执行的查询结束，避免对象析构后后台线程仍在访问
+void TablePager::cancelPrefetch()
+{
+    if(isPrefetching)
+    {
+        prefetchFuture.waitForFinished();
+        isPrefetching = false;
+    }
+}
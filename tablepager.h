@@ -0,0 +1,71 @@
+/*
+ *@file:   tablepager.h
+ *@date:   2026.10.19
+ *@brief:  大表的分页浏览
+ * 界面翻页原来在selectSingleColDatas()的whereSql中拼接"limit/offset"，sqlite需要先扫描并
+ * 丢弃offset行，越往后翻越慢。TablePager基于DatabaseManager::selectPage()的游标(seek)分页，
+ * 记住上一页最后一行的键值，下一页从该键值之后开始查询，任意一页的代价都相同。
+ * 开启预取后，每返回一页就在后台线程查询下一页，用户翻页时通常可以直接拿到结果。
+ *
+ * 用法:
+ *   TablePager pager(databaseManager,"aa",columnNames,"id",100);
+ *   pager.setPrefetchEnabled(true);
+ *   while(pager.hasMore())
+ *   {
+ *       QList<QVariantList> rows = pager.nextPage();
+ *   }
+ *
+ * 注:1.游标列需要有索引(或为主键)且值唯一。
+ *    2.预取的页是查询时刻的数据，预取之后到翻页之间的修改不会反映在该页中。
+ *    3.TablePager对象本身不是线程安全的，应在同一个线程(通常是界面线程)中使用。
+ */
+#ifndef TABLEPAGER_H
+#define TABLEPAGER_H
+
+#include <QFuture>
+#include "databasemanager.h"
+
+class TablePager
+{
+public:
+    TablePager(DatabaseManager *databaseManager,QString tableName,QList<QString> columnNames,
+               QString orderColumnName,int pageSize,QString whereSql=QString(),bool isDescending=false);
+    ~TablePager();
+
+    void setPrefetchEnabled(bool enabled);//开启后在后台预取下一页
+    bool hasMore();//是否还有下一页
+    QVariant cursor();//下一页的游标 无效的数据表示从第一页开始
+    void seek(QVariant afterKey);//从指定键值之后开始翻页
+    void reset();//回到第一页
+    //查询下一页 失败或没有更多数据时返回空的列表
+    QList<QVariantList> nextPage();
+
+private:
+    struct Page
+    {
+        Page():isSuccess(false){}
+        bool isSuccess;
+        QVariant afterKey;//该页的起始游标
+        QList<QVariantList> rows;
+        QVariant nextKey;
+    };
+    Page fetchPage(const QVariant &afterKey);
+    void startPrefetch();
+    void cancelPrefetch();
+
+    DatabaseManager *databaseManager;
+    QString tableName;
+    QList<QString> columnNames;
+    QString orderColumnName;
+    int pageSize;
+    QString whereSql;
+    bool isDescending;
+
+    bool isPrefetchEnabled;
+    bool isFinished;//已经返回了最后一页
+    QVariant nextKey;
+    bool isPrefetching;//是否已开始预取
+    QFuture<Page> prefetchFuture;//预取的下一页
+};
+
+#endif // TABLEPAGER_H
@@ -0,0 +1,317 @@
+/*
+ *@file:   tableschema.h
+ *@date:   2026.10.19
+ *@brief:  编译期表结构定义
+ * DatabaseManager的通用接口每次调用都要用QString::arg()和循环拼接sql语句(占位符、set子句等)。
+ * 对于结构固定、调用频繁的表，可以用该头文件把表结构声明成一个C++类型，建表/插入/修改/查询/
+ * 删除语句在编译期生成为常量字符串，运行时首次使用转换成QString后一直复用，调用时不再拼接
+ * sql；同时列数和列的C++类型由函数签名在编译期检查。例:
+ *    namespace Student {
+ *    SCHEMA_TABLE_NAME(Table,"student");
+ *    SCHEMA_COLUMN(Id,"id",qint64,"integer primary key");
+ *    SCHEMA_COLUMN(Name,"name",QString,"varchar(20)");
+ *    SCHEMA_COLUMN(Score,"score",double,"float");
+ *    typedef TableSchema<Table,Id,Name,Score> Schema;
+ *    }
+ *    Student::Schema::create(databaseManager);
+ *    Student::Schema::insert(databaseManager,101,QString("aa"),90.5);
+ *    Student::Schema::update<Student::Id>(databaseManager,101,QString("bb"),95.0);//按id修改整行
+ *    QVariantList row = Student::Schema::select<Student::Id>(databaseManager,101);
+ *    Student::Schema::remove<Student::Id>(databaseManager,101);
+ *
+ * 注:1.需要C++14(constexpr函数内的循环)，见DatabaseManager.pro中的CONFIG += c++14。
+ *    2.列的C++类型只支持整型(int/uint/qint64/quint64/bool)、double、QString和QByteArray，
+ *      这些类型绑定到sqlite时不会发生隐式的文本转换，其他类型编译报错。
+ *    3.表名和列名必须是字符串字面量。
+ *    4.sql中的表名固定，不经过内存暂存(enableStaging())，暂存的表调用插入/修改/查询/删除都返回失败。
+ *      值也不经过透明压缩，配置了压缩列(setColumnCompression())的表同样返回失败。
+ */
+#ifndef TABLESCHEMA_H
+#define TABLESCHEMA_H
+
+#include <cstddef>
+#include <type_traits>
+#include <QString>
+#include <QByteArray>
+#include <QVariant>
+#include "databasemanager.h"
+
+/*****编译期字符串*******/
+//定长字符串 字符数为N，以'\0'结尾，可以在constexpr函数中拼接
+template<std::size_t N>
+struct SqlString
+{
+    char data[N+1];
+    static constexpr std::size_t size() { return N; }
+};
+//由字符串字面量构造
+template<std::size_t N>
+constexpr SqlString<N-1> sqlString(const char (&text)[N])
+{
+    SqlString<N-1> result{};
+    for(std::size_t i=0;i<N;i++)
+    {
+        result.data[i] = text[i];
+    }
+    return result;
+}
+//拼接
+template<std::size_t N,std::size_t M>
+constexpr SqlString<N+M> operator+(const SqlString<N> &left,const SqlString<M> &right)
+{
+    SqlString<N+M> result{};
+    for(std::size_t i=0;i<N;i++)
+    {
+        result.data[i] = left.data[i];
+    }
+    for(std::size_t i=0;i<=M;i++)
+    {
+        result.data[N+i] = right.data[i];
+    }
+    return result;
+}
+//count个以逗号分隔的占位符 例如count=3时为"?,?,?"
+template<std::size_t Count>
+constexpr SqlString<Count*2-1> sqlPlaceholders()
+{
+    static_assert(Count > 0,"placeholder count must be greater than 0");
+    SqlString<Count*2-1> result{};
+    for(std::size_t i=0;i<Count;i++)
+    {
+        result.data[i*2] = '?';
+        if(i+1 < Count)
+        {
+            result.data[i*2+1] = ',';
+        }
+    }
+    result.data[Count*2-1] = '\0';
+    return result;
+}
+
+/*****表名与列的声明*******/
+//声明表名 Tag为类型名，TableName为表名字面量
+#define SCHEMA_TABLE_NAME(Tag,TableName) \
+    struct Tag \
+    { \
+        static constexpr auto name() { return sqlString(TableName); } \
+    }
+//声明列 Tag为类型名，ColumnName为列名字面量，CppType为列值的C++类型，SqlDeclaration为建表时的类型及约束
+#define SCHEMA_COLUMN(Tag,ColumnName,CppType,SqlDeclaration) \
+    struct Tag \
+    { \
+        typedef CppType Type; \
+        static constexpr auto name() { return sqlString(ColumnName); } \
+        static constexpr auto declaration() { return sqlString(ColumnName " " SqlDeclaration); } \
+    }
+
+namespace TableSchemaDetail {
+//绑定到sqlite时类型不会被转换成文本的C++类型
+template<typename T>
+struct IsSupportedType
+{
+    static constexpr bool value = std::is_same<T,int>::value || std::is_same<T,uint>::value ||
+            std::is_same<T,qint64>::value || std::is_same<T,quint64>::value ||
+            std::is_same<T,bool>::value || std::is_same<T,double>::value ||
+            std::is_same<T,QString>::value || std::is_same<T,QByteArray>::value;
+};
+template<typename... Columns>
+struct AllSupported;
+template<>
+struct AllSupported<>
+{
+    static constexpr bool value = true;
+};
+template<typename First,typename... Rest>
+struct AllSupported<First,Rest...>
+{
+    static constexpr bool value = IsSupportedType<typename First::Type>::value && AllSupported<Rest...>::value;
+};
+//列在表中的下标 不存在时为-1
+template<typename Column,typename... Columns>
+struct ColumnIndex;
+template<typename Column>
+struct ColumnIndex<Column>
+{
+    static constexpr int value = -1;
+};
+template<typename Column,typename First,typename... Rest>
+struct ColumnIndex<Column,First,Rest...>
+{
+    static constexpr int next = ColumnIndex<Column,Rest...>::value;
+    static constexpr int value = std::is_same<Column,First>::value ? 0 : (next < 0 ? -1 : next+1);
+};
+//列是否重复声明
+template<typename... Columns>
+struct HasDuplicate;
+template<>
+struct HasDuplicate<>
+{
+    static constexpr bool value = false;
+};
+template<typename First,typename... Rest>
+struct HasDuplicate<First,Rest...>
+{
+    static constexpr bool value = ColumnIndex<First,Rest...>::value >= 0 || HasDuplicate<Rest...>::value;
+};
+//以逗号连接各列的某一项(列名、建表声明、set子句)
+struct NameOf
+{
+    template<typename Column>
+    static constexpr auto get() { return Column::name(); }
+};
+struct DeclarationOf
+{
+    template<typename Column>
+    static constexpr auto get() { return Column::declaration(); }
+};
+struct AssignmentOf
+{
+    template<typename Column>
+    static constexpr auto get() { return Column::name()+sqlString("=?"); }
+};
+template<typename Item,typename Column>
+constexpr auto join()
+{
+    return Item::template get<Column>();
+}
+template<typename Item,typename First,typename Second,typename... Rest>
+constexpr auto join()
+{
+    return Item::template get<First>()+sqlString(",")+join<Item,Second,Rest...>();
+}
+}
+
+template<typename Table,typename... Columns>
+class TableSchema
+{
+    static_assert(sizeof...(Columns) > 0,"table schema needs at least one column");
+    static_assert(TableSchemaDetail::AllSupported<Columns...>::value,
+                  "column type must be int/uint/qint64/quint64/bool/double/QString/QByteArray");
+    static_assert(!TableSchemaDetail::HasDuplicate<Columns...>::value,"column declared more than once");
+
+public:
+    static constexpr int columnCount() { return int(sizeof...(Columns)); }
+    template<typename Column>
+    static constexpr int indexOf()
+    {
+        static_assert(TableSchemaDetail::ColumnIndex<Column,Columns...>::value >= 0,"column is not in the table");
+        return TableSchemaDetail::ColumnIndex<Column,Columns...>::value;
+    }
+
+    /*****编译期生成的sql语句*******/
+    static constexpr auto createSqlText()
+    {
+        return sqlString("create table if not exists ")+Table::name()+sqlString("(")+
+                TableSchemaDetail::join<TableSchemaDetail::DeclarationOf,Columns...>()+sqlString(");");
+    }
+    static constexpr auto insertSqlText()
+    {
+        return sqlString("insert into ")+Table::name()+sqlString("(")+
+                TableSchemaDetail::join<TableSchemaDetail::NameOf,Columns...>()+sqlString(") values(")+
+                sqlPlaceholders<sizeof...(Columns)>()+sqlString(");");
+    }
+    template<typename Key>
+    static constexpr auto updateSqlText()
+    {
+        return sqlString("update ")+Table::name()+sqlString(" set ")+
+                TableSchemaDetail::join<TableSchemaDetail::AssignmentOf,Columns...>()+
+                sqlString(" where ")+Key::name()+sqlString("=?;");
+    }
+    template<typename Key>
+    static constexpr auto selectSqlText()
+    {
+        return sqlString("select ")+TableSchemaDetail::join<TableSchemaDetail::NameOf,Columns...>()+
+                sqlString(" from ")+Table::name()+sqlString(" where ")+Key::name()+sqlString("=?;");
+    }
+    template<typename Key>
+    static constexpr auto deleteSqlText()
+    {
+        return sqlString("delete from ")+Table::name()+sqlString(" where ")+Key::name()+sqlString("=?;");
+    }
+
+    /*****运行期使用的sql 首次使用时由编译期字符串构造，之后一直复用*******/
+    static const QString &tableName()
+    {
+        static constexpr auto text = Table::name();
+        static const QString name = QString::fromLatin1(text.data,int(text.size()));
+        return name;
+    }
+    static const QString &createSql()
+    {
+        static constexpr auto text = createSqlText();
+        static const QString sql = QString::fromLatin1(text.data,int(text.size()));
+        return sql;
+    }
+    static const QString &insertSql()
+    {
+        static constexpr auto text = insertSqlText();
+        static const QString sql = QString::fromLatin1(text.data,int(text.size()));
+        return sql;
+    }
+    template<typename Key>
+    static const QString &updateSql()
+    {
+        static constexpr auto text = updateSqlText<Key>();
+        static const QString sql = QString::fromLatin1(text.data,int(text.size()));
+        return sql;
+    }
+    template<typename Key>
+    static const QString &selectSql()
+    {
+        static constexpr auto text = selectSqlText<Key>();
+        static const QString sql = QString::fromLatin1(text.data,int(text.size()));
+        return sql;
+    }
+    template<typename Key>
+    static const QString &deleteSql()
+    {
+        static constexpr auto text = deleteSqlText<Key>();
+        static const QString sql = QString::fromLatin1(text.data,int(text.size()));
+        return sql;
+    }
+
+    /*****数据操作 参数的个数和类型与列的声明一一对应*******/
+    static bool create(DatabaseManager *manager)
+    {
+        return manager->createTable(createSql());
+    }
+    static bool insert(DatabaseManager *manager,const typename Columns::Type &... values)
+    {
+        return manager->execSchemaSql(tableName(),insertSql(),bindValues(values...));
+    }
+    //按Key列的值修改整行 Key列的值取自values中对应的参数
+    template<typename Key>
+    static bool update(DatabaseManager *manager,const typename Columns::Type &... values)
+    {
+        QVariantList rowValues = bindValues(values...);
+        rowValues.append(rowValues.at(indexOf<Key>()));
+        return manager->execSchemaSql(tableName(),updateSql<Key>(),rowValues);
+    }
+    //按Key列的值查询整行 没有记录时返回空的列表
+    template<typename Key>
+    static QVariantList select(DatabaseManager *manager,const typename Key::Type &keyValue)
+    {
+        static_assert(indexOf<Key>() >= 0,"column is not in the table");
+        QVariantList values;
+        manager->selectSchemaSql(tableName(),selectSql<Key>(),QVariantList()<<QVariant(keyValue),values,1);
+        return values;
+    }
+    template<typename Key>
+    static bool remove(DatabaseManager *manager,const typename Key::Type &keyValue)
+    {
+        static_assert(indexOf<Key>() >= 0,"column is not in the table");
+        return manager->execSchemaSql(tableName(),deleteSql<Key>(),QVariantList()<<QVariant(keyValue));
+    }
+
+private:
+    static QVariantList bindValues(const typename Columns::Type &... values)
+    {
+        QVariantList rowValues;
+        rowValues.reserve(int(sizeof...(Columns)));
+        int expand[] = {(rowValues.append(QVariant(values)),0)...};
+        Q_UNUSED(expand);
+        return rowValues;
+    }
+};
+
+#endif // TABLESCHEMA_H
@@ -1,7 +1,23 @@
 #include "widget.h"
 #include "ui_widget.h"
+#include "readsnapshot.h"
+#include "tableschema.h"
+#include "partitionedtable.h"
+#include "cappedtable.h"
+#include "shardeddatabasemanager.h"
+#include "tablepager.h"
 
 DatabaseManager *databaseManager;
+DatabaseScheduler *databaseScheduler;
+//编译期表结构 与建表按钮创建的表结构一致，sql语句在编译期生成
+namespace Student {
+SCHEMA_TABLE_NAME(Table,"student");
+SCHEMA_COLUMN(Id,"id",int,"int");
+SCHEMA_COLUMN(Name,"name",QString,"varchar(20)");
+SCHEMA_COLUMN(Score,"score",double,"float");
+SCHEMA_COLUMN(Age,"age",int,"int");
+typedef TableSchema<Table,Id,Name,Score,Age> Schema;
+}
 
 Widget::Widget(QWidget *parent) :
     QWidget(parent),
@@ -9,6 +25,19 @@ Widget::Widget(QWidget *parent) :
 {
     ui->setupUi(this);
     databaseManager = new DatabaseManager("test");
+    databaseScheduler = new DatabaseScheduler(databaseManager);
+    //数据变更通知 提交后才收到变化的表和行，不需要定时轮询
+    connect(databaseManager,&DatabaseManager::tableChanged,this,[](QList<TableChange> changes){
+        for(int i=0;i<changes.size();i++)
+        {
+            qDebug()<<"table changed:"<<changes.at(i).tableName<<changes.at(i).operation
+                   <<(changes.at(i).isAllRows ? -1 : changes.at(i).rowids.size());
+        }
+    });
+    //后台完整性检测的结果 在后台线程中发送，通过队列连接回到界面线程
+    connect(databaseManager,&DatabaseManager::integrityChecked,this,[](bool isIntegrity){
+        qDebug()<<"integrity_check:"<<isIntegrity<<"usecs:"<<databaseManager->startupStats().integrityCheckUsecs;
+    });
     thread = new MyThread();
     thread2 = new MyThread2();
 
@@ -22,11 +51,24 @@ Widget::~Widget()
 void Widget::on_pushButton_clicked()
 {
     QString databaseName = ui->lineEdit->text();
-    if(databaseManager->createSqliteConnection(databaseName))
+    SqliteConnectionOptions options;
+    options.mmapSize = 64*1024*1024;//内存映射64MB
+    options.cacheSize = -8192;//页缓存8MB
+    //快速启动 完整性检测和预读在后台执行，常用的查询在打开时预处理
+    options.walMode = true;
+    options.backgroundIntegrityCheck = true;
+    options.warmupStatements<<"select * from student where id=?;";
+    options.prefetchTables<<"student";
+    //数据库被其他连接锁定时退避重试 查询最多等1s，写操作最多等10s
+    databaseManager->setBusyRetryPolicy(BusyRetryPolicy(1000),BusyRetryPolicy(10000,2,200));
+    if(databaseManager->createSqliteConnection(databaseName,options))
     {
         ui->recordLabel->setText("create sqlite connection success;");
+        databaseManager->enableChangeNotification();
+        StartupStats stats = databaseManager->startupStats();
+        qDebug()<<"startup usecs: open"<<stats.openUsecs<<"pragma"<<stats.pragmaUsecs<<"warm up"<<stats.warmupUsecs
+               <<"ready"<<stats.readyUsecs<<"warmed statements:"<<stats.warmedStatements;
     }
-    qDebug()<<"integrity_check:"<<databaseManager->integrityCheck();
 }
 //建表
 void Widget::on_pushButton_2_clicked()
@@ -71,6 +113,24 @@ void Widget::on_pushButton_4_clicked()
         ui->recordLabel->setText("insert table success;");
     }
     qDebug()<<"insert table end:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
+    //大字段透明压缩 写入时压缩，查询返回原来的字符串
+    ColumnCompressionOptions compressionOptions;
+    compressionOptions.dictionary = QByteArray("{\"name\":\"\",\"score\":,\"age\":,\"remark\":\"\"}");
+    if(databaseManager->setColumnCompression(tableName,"name",compressionOptions))
+    {
+        QString longName = QString("{\"name\":\"%1\",\"remark\":\"%2\"}").arg(QString::fromUtf8("狗剩"),QString(512,'a'));
+        databaseManager->updateTable(tableName,"name",longName,"id",101);
+        qDebug()<<"compressed column:"<<(databaseManager->selectSingleColData(tableName,"name","id",101).toString() == longName)
+               <<"saved bytes:"<<databaseManager->columnCompressionStats().value(tableName.toLower()+".name").savedBytes();
+        databaseManager->removeColumnCompression(tableName,"name");
+    }
+    //编译期表结构 参数的个数和类型在编译期检查，调用时不拼接sql
+    Student::Schema::create(databaseManager);
+    if(Student::Schema::insert(databaseManager,103,QString::fromUtf8("铁柱"),88.0,19))
+    {
+        Student::Schema::update<Student::Id>(databaseManager,103,QString::fromUtf8("铁柱"),92.5,19);
+        qDebug()<<"schema select row:"<<Student::Schema::select<Student::Id>(databaseManager,103);
+    }
 }
 //插数(批量 事务操作)  在板子上测试１s时间大约能插入一万多条数据
 void Widget::on_pushButton_5_clicked()
@@ -93,7 +153,8 @@ void Widget::on_pushButton_5_clicked()
     }
     list<<idList<<nameList<<scoreList<<ageList;
     qDebug()<<"insert  batch table start:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
-    if(databaseManager->insertBatchTable(tableName,list))
+    //通过调度器按批量优先级分批插入，批次之间其他线程的交互查询可以插队
+    if(databaseScheduler->insertBatchTable(tableName,list))
     {
         ui->recordLabel->setText("insert  batch table success;");
     }
@@ -111,6 +172,22 @@ void Widget::on_pushButton_6_clicked()
         ui->recordLabel->setText("insert  batch table success;");
     }
     qDebug()<<"insert  batch table end:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
+    //环形缓冲表 只保留最近100条，表满后覆盖最旧的记录，写入代价不随表的填充程度变化
+    CappedTable eventLog(databaseManager,"event_log",100);
+    QList<QString> columnNames;
+    QList<QString> columnTypes;
+    columnNames<<"time"<<"message";
+    columnTypes<<"integer"<<"text";
+    if(eventLog.create(columnNames,columnTypes))
+    {
+        for(int i=0;i<150;i++)
+        {
+            QVariantList rowValues;
+            rowValues<<QDateTime::currentMSecsSinceEpoch()<<QString("event %1").arg(eventLog.nextSequence());
+            eventLog.insert(rowValues);
+        }
+        qDebug()<<"event log rows:"<<eventLog.rowCount()<<"latest:"<<eventLog.selectLatest(QList<QString>(),3);
+    }
 }
 //改数(单条)
 void Widget::on_pushButton_7_clicked()
@@ -155,6 +232,18 @@ void Widget::on_pushButton_8_clicked()
     {
         qDebug()<<"delete table success;";
     }
+    //按键值列表批量删除
+    QVariantList idValues;
+    for(int i=110;i<1200;i++)
+    {
+        idValues<<i;
+    }
+    qDebug()<<"delete batch table start:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
+    if(databaseManager->deleteBatchTable(tableName,"id",idValues))
+    {
+        qDebug()<<"delete batch table success;";
+    }
+    qDebug()<<"delete batch table end:"<<QTime::currentTime().toString("hh:mm:ss:zzz");
 }
 //删数(整表)
 void Widget::on_pushButton_9_clicked()
@@ -164,6 +253,29 @@ void Widget::on_pushButton_9_clicked()
     {
         ui->recordLabel->setText("delete table success;");
     }
+    //分区表 按天写入不同的物理表，清理过期数据时直接删除整个分区
+    PartitionedTable telemetry(databaseManager,"telemetry","ts",PartitionedTable::Daily);
+    QList<QString> columnNames;
+    QList<QString> columnTypes;
+    columnNames<<"ts"<<"channel"<<"value";
+    columnTypes<<"integer"<<"int"<<"real";
+    telemetry.setSchema(columnNames,columnTypes);
+    qint64 now = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch()/1000;
+    QVariantList tsList;
+    QVariantList channelList;
+    QVariantList valueList;
+    for(int i=0;i<10*24;i++)//最近10天每小时一条
+    {
+        tsList<<now-i*3600;
+        channelList<<i%4;
+        valueList<<qrand()%1000/10.0;
+    }
+    QList<QVariantList> list;
+    list<<tsList<<channelList<<valueList;
+    telemetry.insertBatch(list);
+    qDebug()<<"telemetry partitions:"<<telemetry.partitions();
+    qDebug()<<"telemetry last day rows:"<<telemetry.selectRowCount(now-86400,now+1);
+    qDebug()<<"telemetry dropped partitions:"<<telemetry.dropPartitionsBefore(now-7*86400);
 }
 //查表
 void Widget::on_pushButton_10_clicked()
@@ -179,6 +291,95 @@ void Widget::on_pushButton_10_clicked()
     qDebug()<<"id = 2 row number:"<<countNum1;
     qDebug()<<"id != 2 row number:"<<countNum2;
     ui->recordLabel->setText(QString::number(countNum1)+"   "+QString::number(countNum2));
+    //按键值列表批量查询
+    QVariantList idValues;
+    idValues<<1<<2<<3<<101<<102;
+    QHash<QString,QVariantList> rows = databaseManager->selectBatchMultiColData(tableName,QList<QString>()<<"name"<<"score","id",idValues);
+    qDebug()<<"select batch rows:"<<rows;
+    //对比普通查询接口与内存池结果集的耗时及内存分配次数
+    QTime benchmarkTime;
+    benchmarkTime.start();
+    QVariantList names = databaseManager->selectSingleColDatas(tableName,"name",false);
+    qDebug()<<"select QVariantList rows:"<<names.size()<<"time(ms):"<<benchmarkTime.elapsed();
+    ArenaResultSet resultSet;
+    for(int i=0;i<2;i++)//第二次查询复用第一次分配的内存块
+    {
+        benchmarkTime.restart();
+        databaseManager->selectResultSet(resultSet,tableName,QList<QString>()<<"name");
+        qDebug()<<"select ArenaResultSet rows:"<<resultSet.rowCount()<<"time(ms):"<<benchmarkTime.elapsed()
+               <<"allocations:"<<resultSet.allocationCount()<<"bytes:"<<resultSet.bytesUsed();
+    }
+    //对比sqlite3原生接口与QSqlQuery执行相同的单行查询的耗时
+    for(int i=0;i<2;i++)
+    {
+        databaseManager->setNativeApiEnabled(i == 0);
+        benchmarkTime.restart();
+        for(int id=1;id<=1000;id++)
+        {
+            databaseManager->selectSingleColData(tableName,"name","id",id);
+        }
+        qDebug()<<(i == 0 ? "native api" : "QSqlQuery")<<"1000 selects time(ms):"<<benchmarkTime.elapsed();
+    }
+    databaseManager->setNativeApiEnabled(true);
+    //常驻内存的表 按键值的查询直接从镜像返回
+    if(databaseManager->pinTable(tableName,"id"))
+    {
+        benchmarkTime.restart();
+        for(int id=1;id<=1000;id++)
+        {
+            databaseManager->selectSingleColData(tableName,"name","id",id);
+        }
+        qDebug()<<"pinned table 1000 selects time(ms):"<<benchmarkTime.elapsed();
+        databaseManager->unpinTable(tableName);
+    }
+    //对比limit/offset与游标分页查询靠后的一页的耗时
+    benchmarkTime.restart();
+    databaseManager->selectSingleColDatas(tableName,"name",false,"1=1 order by id limit 100 offset 90000");
+    qDebug()<<"offset page time(ms):"<<benchmarkTime.elapsed();
+    QList<QVariantList> pageRows;
+    QVariant nextKey;
+    benchmarkTime.restart();
+    databaseManager->selectPage(pageRows,nextKey,tableName,QList<QString>()<<"name","id",89999,100);
+    qDebug()<<"keyset page time(ms):"<<benchmarkTime.elapsed()<<"rows:"<<pageRows.size()<<"next key:"<<nextKey;
+    TablePager pager(databaseManager,tableName,QList<QString>()<<"id"<<"name","id",100);
+    pager.setPrefetchEnabled(true);//翻页时下一页已在后台查询
+    for(int i=0;i<3 && pager.hasMore();i++)
+    {
+        qDebug()<<"page"<<i<<"rows:"<<pager.nextPage().size()<<"cursor:"<<pager.cursor();
+    }
+    PageCacheStats cacheStats = databaseManager->pageCacheStats();
+    qDebug()<<"page cache hit:"<<cacheStats.hits<<"miss:"<<cacheStats.misses<<"write:"<<cacheStats.writes
+           <<"hit ratio:"<<cacheStats.hitRatio()<<"used bytes:"<<cacheStats.usedBytes;
+    //读快照 两次查询看到同一时刻的数据，期间其他线程的写操作不受影响
+    ReadSnapshot snapshot(databaseManager);
+    if(snapshot.isValid())
+    {
+        qDebug()<<"snapshot row number:"<<snapshot.selectRowCount(tableName)
+               <<snapshot.selectSingleColDatas(tableName,"id").size();
+    }
+    //操作期限 没有索引的模糊查询扫描整个表，超过50ms时中断并释放读锁
+    {
+        OperationDeadline deadline(50);
+        QVariantList ids = databaseManager->selectSingleColDatas(tableName,"id",false,"name like '%e%' order by score");
+        qDebug()<<"deadline query rows:"<<ids.size()<<"interrupted:"<<deadline.isInterrupted();
+    }
+    //全文检索 查询走全文索引，不需要like '%...%'扫描整个表
+    if(databaseManager->createFullTextIndex(tableName,QList<QString>()<<"name"))
+    {
+        QList<FullTextMatch> matches = databaseManager->search(tableName,"eadf OR aeh",5);
+        for(int i=0;i<matches.size();i++)
+        {
+            qDebug()<<"full text match:"<<matches.at(i).rowid<<matches.at(i).rank<<matches.at(i).snippet;
+        }
+    }
+    //多维范围查询 score在[86,88]且age在[17,18]的行，由R*Tree同时按两列定位
+    if(databaseManager->createRangeIndex(tableName,QList<QString>()<<"score"<<"age"))
+    {
+        QList<QVariantList> rangeRows = databaseManager->selectRangeRows(tableName,QList<QString>()<<"id"<<"score"<<"age",
+                                                                         QVariantList()<<86<<17,QVariantList()<<88<<18,10);
+        qDebug()<<"range rows:"<<rangeRows.size()<<"rowids:"
+               <<databaseManager->selectRangeRowids(tableName,QVariantList()<<86,QVariantList()<<QVariant(),5);
+    }
     //单行多列
     /*QList<QString> columnNames;
     columnNames<<"id"<<"name";
@@ -225,6 +426,11 @@ void Widget::on_pushButton_12_clicked()
 //开启子线程
 void Widget::on_pushButton_13_clicked()
 {
+    //线程1高频写入aa表，写入先暂存在内存数据库，每500ms或暂存5000行时批量写入磁盘
+    StagingOptions options;
+    options.flushIntervalMsecs = 500;
+    options.flushRowCount = 5000;
+    databaseManager->enableStaging(QList<QString>()<<"aa",options);
     thread->start();
 }
 //开启子线程2
@@ -236,6 +442,12 @@ void Widget::on_pushButton_14_clicked()
 void Widget::on_pushButton_15_clicked()
 {
     thread->stop();
+    thread->wait();
+    StagingStats stagingStats = databaseManager->stagingStats();
+    qDebug()<<"staging rows:"<<stagingStats.stagedRows<<"flush count:"<<stagingStats.flushCount
+           <<"flushed rows:"<<stagingStats.flushedRows<<"max loss(ms/rows):"<<stagingStats.maxLossMsecs
+           <<stagingStats.maxLossRows;
+    databaseManager->disableStaging();
 }
 //关闭子线程2
 void Widget::on_pushButton_16_clicked()
@@ -249,6 +461,18 @@ void Widget::on_pushButton_17_clicked()
     QString desTableName = ui->lineEdit_12->text();
     databaseManager->copyTable("aa",desTableName);
     qDebug()<<"copy table stop:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
+    //增量复制 第一次全量复制，之后只复制aa表新增的行
+    qDebug()<<"delta copy table:"<<databaseManager->copyTableDelta("aa",desTableName+"_delta");
+    //增量同步 只导出aa表上次导出之后变化的行，再应用到test2.db中
+    if(databaseManager->startChangeCapture("aa","id") && databaseManager->writeChangeset("aa","./aa.changeset"))
+    {
+        DatabaseManager syncManager("sync");
+        if(syncManager.createSqliteConnection("./test2.db"))
+        {
+            qDebug()<<"apply changeset:"<<syncManager.applyChangeset("./aa.changeset",Changeset::Replace);
+            syncManager.closeConnection();
+        }
+    }
 }
 //复制表　数据库间
 void Widget::on_pushButton_18_clicked()
@@ -257,6 +481,37 @@ void Widget::on_pushButton_18_clicked()
     QString desTableName = ui->lineEdit_13->text();
     databaseManager->copyTable("./test2.db","aa",desTableName);
     qDebug()<<"copy2 table stop:"<<QTime::currentTime().toString("HH:mm:ss:zzz");
+    //分片 aa表的数据按id分散到4个数据库文件，批量插入和统计查询在各分片上并行执行
+    ShardedDatabaseManager sharded("shard",4);
+    if(!sharded.createSqliteConnection("./shard.db"))
+    {
+        return;
+    }
+    QList<QString> columnNames;
+    columnNames<<"id"<<"name"<<"score";
+    QList<QString> columnTypes;
+    columnTypes<<"int primary key"<<"varchar(20)"<<"float";
+    //表已存在时只登记分片键
+    if(!sharded.setShardKey("aa","id") && !sharded.createTable("aa",columnNames,columnTypes,"id"))
+    {
+        return;
+    }
+    QList<QVariantList> columnValues;
+    columnValues<<QVariantList()<<QVariantList()<<QVariantList();
+    int startId = sharded.selectRowCount("aa");
+    for(int i=startId;i<startId+10000;i++)
+    {
+        columnValues[0].append(i);
+        columnValues[1].append(QString("name%1").arg(i));
+        columnValues[2].append(i%100);
+    }
+    QTime shardTime;
+    shardTime.start();
+    sharded.insertBatchTable("aa",columnValues,columnNames);
+    qDebug()<<"sharded insert 10000 rows time(ms):"<<shardTime.elapsed();
+    qDebug()<<"sharded row count:"<<sharded.selectRowCount("aa")<<"avg score:"
+           <<sharded.selectAggregate("aa","avg","score")<<"row 100:"
+           <<sharded.selectMultiColData("aa",QList<QString>(),"id",100);
 }
 //查询表是否存在
 void Widget::on_pushButton_19_clicked()
@@ -264,4 +519,26 @@ void Widget::on_pushButton_19_clicked()
     QString tableName = ui->lineEdit_14->text();
     bool isExist = databaseManager->isExistTable(tableName);
     qDebug()<<"the table isExist is "<<isExist;
+    //各表的锁竞争统计
+    QHash<QString,TableLockStats> lockStats = databaseManager->lockStatistics();
+    QHash<QString,TableLockStats>::const_iterator it = lockStats.constBegin();
+    for(;it != lockStats.constEnd();++it)
+    {
+        qDebug()<<"lock stats:"<<it.key()<<it.value().acquisitions<<it.value().contentions<<it.value().waitMsecs;
+    }
+    //数据库文件锁(其他连接或进程)的等待统计
+    BusyStats writeBusy = databaseManager->busyStats(DatabaseManager::WriteAccess);
+    qDebug()<<"write busy stats:"<<writeBusy.busyEvents<<writeBusy.retries<<writeBusy.timeouts<<writeBusy.waitMsecs;
+    //交互查询通过调度器执行，线程1的批量写入在批次之间让出
+    QVariantList row;
+    databaseScheduler->run(DatabaseScheduler::Interactive,[&](DatabaseManager *manager){
+        row = manager->selectMultiColData("aa",QList<QString>(),"id",1);
+        return !row.isEmpty();
+    },DatabaseScheduler::Read);
+    for(int i=0;i<DatabaseScheduler::PriorityCount;i++)
+    {
+        SchedulerStats schedulerStats = databaseScheduler->stats(DatabaseScheduler::Priority(i));
+        qDebug()<<"scheduler stats:"<<i<<schedulerStats.queueDepth<<schedulerStats.executed
+               <<schedulerStats.avgWaitMsecs()<<schedulerStats.maxWaitMsecs<<schedulerStats.agedStarts;
+    }
 }